@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+/*
+ * Stress test for osgXR frame handling.
+ *
+ * This runs a multithreaded viewer with a configurable number of OpenXR frames
+ * in flight, and randomly skips drawing of the XR cameras on some frames, so
+ * that frames are waited for but never begun by a draw. Concurrent frame
+ * lookups come from the per-camera cull threads, while waiting, discarding and
+ * ending frames happen on the update and draw threads.
+ *
+ * Environment variables:
+ *  OSGXR_STRESS_FRAMES:     Number of frames to run for (default 2000).
+ *  OSGXR_STRESS_SKIP:       Skip XR drawing on 1 in N frames (default 4).
+ *  OSGXR_FRAMES_IN_FLIGHT:  Maximum OpenXR frames in flight (default 2).
+ *  OSGXR_FRAME_PACING:      Non-zero to wait for frames in a pacing thread.
+ *
+ * It should run to completion without hanging, and without the runtime or
+ * validation layer reporting frame call order errors. It needs a running
+ * OpenXR runtime, so it is a manual check rather than an automated test. The
+ * exit status is non-zero if the viewer stops before all frames have run.
+ */
+
+#include <osg/Geode>
+#include <osg/Shape>
+#include <osg/ShapeDrawable>
+#include <osg/os_utils>
+
+#include <osgViewer/Viewer>
+
+#include <osgXR/OpenXRDisplay>
+#include <osgXR/Settings>
+
+#include <cstdlib>
+#include <iostream>
+
+int main(int, char **)
+{
+    unsigned int numFrames = 2000;
+    unsigned int skip = 4;
+    unsigned int framesInFlight = 2;
+    unsigned int framePacing = 0;
+    osg::getEnvVar("OSGXR_STRESS_FRAMES", numFrames);
+    osg::getEnvVar("OSGXR_STRESS_SKIP", skip);
+    osg::getEnvVar("OSGXR_FRAMES_IN_FLIGHT", framesInFlight);
+    osg::getEnvVar("OSGXR_FRAME_PACING", framePacing);
+
+    osg::ref_ptr<osgViewer::Viewer> viewer = new osgViewer::Viewer;
+    // Separate cull threads per camera, overlapping the draw thread
+    viewer->setThreadingModel(osgViewer::Viewer::CullThreadPerCameraDrawThreadPerContext);
+
+    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+    geode->addDrawable(new osg::ShapeDrawable(new osg::Box(osg::Vec3(0.0f, 0.0f, 0.0f), 1.0f)));
+    viewer->setSceneData(geode);
+
+    osgXR::Settings *settings = osgXR::Settings::instance();
+    settings->setApp("osgxrframestress", 1);
+    settings->setFormFactor(osgXR::Settings::HEAD_MOUNTED_DISPLAY);
+    settings->preferEnvBlendMode(osgXR::Settings::BLEND_MODE_OPAQUE);
+    settings->setFramesInFlight(framesInFlight);
+    settings->setFramePacingThread(!!framePacing);
+    viewer->apply(new osgXR::OpenXRDisplay(settings));
+
+    viewer->realize();
+
+    std::srand(1);
+    unsigned int skipped = 0;
+    unsigned int frame;
+    for (frame = 0; frame < numFrames && !viewer->done(); ++frame)
+    {
+        // Randomly stop the XR cameras culling and drawing for a frame
+        bool skipDraw = skip && !(std::rand() % skip);
+        if (skipDraw)
+            ++skipped;
+        for (unsigned int i = 0; i < viewer->getNumSlaves(); ++i)
+        {
+            osg::Camera *camera = viewer->getSlave(i)._camera.get();
+            if (camera->getRenderTargetImplementation() == osg::Camera::FRAME_BUFFER_OBJECT)
+                camera->setNodeMask(skipDraw ? 0x0 : 0xffffffff);
+        }
+
+        viewer->frame();
+    }
+
+    if (frame < numFrames)
+    {
+        std::cerr << "osgxrframestress: Viewer stopped after " << frame
+                  << " of " << numFrames << " frames" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "osgxrframestress: Skipped XR drawing on " << skipped
+              << " frames" << std::endl;
+    return EXIT_SUCCESS;
+}
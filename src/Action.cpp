@@ -8,7 +8,10 @@
 #include "OpenXR/Session.h"
 #include "OpenXR/Space.h"
 
-#include <map>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 using namespace osgXR;
 
@@ -16,7 +19,10 @@ using namespace osgXR;
 
 Action::Private::Private(ActionSet *actionSet) :
     _actionSet(actionSet),
-    _updated(true)
+    _updated(true),
+    _boundSourcesValid(false),
+    _public(nullptr),
+    _eventThreshold(0.5f)
 {
     ActionSet::Private::get(_actionSet)->registerAction(this);
 }
@@ -58,57 +64,108 @@ void Action::Private::cleanupInstance()
 {
     _updated = true;
     _action = nullptr;
+    invalidateBoundSources();
 }
 
 void Action::Private::getBoundSources(std::vector<std::string> &sourcePaths) const
 {
-    OpenXR::Session *session = ActionSet::Private::get(_actionSet)->getSession();
-    if (_action.valid() && session)
+    if (updateBoundSources())
+        sourcePaths = _boundSources;
+    else
+        sourcePaths.resize(0);
+}
+
+void Action::Private::getBoundSourcesLocalizedNames(XrInputSourceLocalizedNameFlags whichComponents,
+                                                    std::vector<std::string> &names) const
+{
+    if (!updateBoundSources())
     {
-        std::vector<XrPath> paths;
-        if (session->getActionBoundSources(_action, paths))
-        {
-            // Convert XrPath's into std::string's
-            OpenXR::Instance *instance = session->getInstance();
-            sourcePaths.resize(paths.size());
-            for (unsigned int i = 0; i < paths.size(); ++i)
-                sourcePaths[i] = OpenXR::Path(instance, paths[i]).toString();
+        // Failure, clear output
+        names.resize(0);
+        return;
+    }
 
-            // Success!
-            return;
-        }
+    auto it = _boundSourceNames.find(whichComponents);
+    if (it == _boundSourceNames.end())
+    {
+        // Get localized names of the cached source paths
+        OpenXR::Session *session = ActionSet::Private::get(_actionSet)->getSession();
+        std::vector<std::string> &newNames = _boundSourceNames[whichComponents];
+        newNames.resize(_boundSourcePaths.size());
+        for (unsigned int i = 0; i < _boundSourcePaths.size(); ++i)
+            newNames[i] = session->getInputSourceLocalizedName(_boundSourcePaths[i],
+                                                               whichComponents);
+        names = newNames;
     }
+    else
+    {
+        names = it->second;
+    }
+}
 
-    // Failure, clear output
-    sourcePaths.resize(0);
+void Action::Private::invalidateBoundSources()
+{
+    _boundSourcesValid = false;
+    _boundSourcePaths.clear();
+    _boundSources.clear();
+    _boundSourceNames.clear();
 }
 
-void Action::Private::getBoundSourcesLocalizedNames(XrInputSourceLocalizedNameFlags whichComponents,
-                                                    std::vector<std::string> &names) const
+bool Action::Private::updateBoundSources() const
 {
+    if (_boundSourcesValid)
+        return true;
+
     OpenXR::Session *session = ActionSet::Private::get(_actionSet)->getSession();
-    if (_action.valid() && session)
+    if (_action.valid() && session &&
+        session->getActionBoundSources(_action, _boundSourcePaths))
     {
-        std::vector<XrPath> paths;
-        if (session->getActionBoundSources(_action, paths))
-        {
-            // Convert XrPath's into localized names
-            names.resize(paths.size());
-            for (unsigned int i = 0; i < paths.size(); ++i)
-                names[i] = session->getInputSourceLocalizedName(paths[i],
-                                                                      whichComponents);
+        // Convert XrPath's into std::string's
+        OpenXR::Instance *instance = session->getInstance();
+        _boundSources.resize(_boundSourcePaths.size());
+        for (unsigned int i = 0; i < _boundSourcePaths.size(); ++i)
+            _boundSources[i] = instance->pathToString(_boundSourcePaths[i]);
+        _boundSourcesValid = true;
+        return true;
+    }
+    return false;
+}
 
-            // Success!
+void Action::Private::enableEvents(std::shared_ptr<Subaction::Private> subaction)
+{
+    for (auto &source: _eventSources)
+        if (source.subaction == subaction)
             return;
-        }
-    }
+    _eventSources.push_back({ subaction, false });
+}
 
-    // Failure, clear output
-    names.resize(0);
+void Action::Private::disableEvents(std::shared_ptr<Subaction::Private> subaction)
+{
+    _eventSources.erase(std::remove_if(_eventSources.begin(), _eventSources.end(),
+                                       [&subaction](const EventSource &source) {
+                                           return source.subaction == subaction;
+                                       }),
+                        _eventSources.end());
 }
 
 namespace osgXR {
 
+// Whether an action value counts as pressed or above the event threshold
+static bool eventOn(bool value, float threshold)
+{
+    return value;
+}
+
+static bool eventOn(float value, float threshold)
+{
+    return value >= threshold;
+}
+
+static bool eventOn(const osg::Vec2f &value, float threshold)
+{
+    return value.length() >= threshold;
+}
+
 template <typename T>
 class ActionPrivateCommon : public Action::Private
 {
@@ -124,6 +181,9 @@ class ActionPrivateCommon : public Action::Private
         void cleanupSession() override
         {
             _states.clear();
+            invalidateBoundSources();
+            for (auto &source: _eventSources)
+                source.on = false;
         }
 
         OpenXR::Action *setup(OpenXR::Instance *instance) override
@@ -138,6 +198,7 @@ class ActionPrivateCommon : public Action::Private
             else if (_updated || actionSet != _action->getActionSet())
             {
                 _action = new T(actionSet, _name, _localizedName);
+                invalidateBoundSources();
                 for (auto &subaction: _subactions)
                     _action->addSubaction(subaction->setup(instance));
                 _updated = false;
@@ -147,9 +208,10 @@ class ActionPrivateCommon : public Action::Private
 
         State *getState(Subaction::Private *subaction = nullptr)
         {
-            auto it = _states.find(subaction);
-            if (it != _states.end())
-                return (*it).second.get();
+            // Actions rarely have more than a couple of subactions
+            for (auto &pair: _states)
+                if (pair.first == subaction)
+                    return pair.second.get();
 
             OpenXR::Session *session = ActionSet::Private::get(_actionSet)->getSession();
             if (session)
@@ -162,7 +224,7 @@ class ActionPrivateCommon : public Action::Private
                 {
                     osg::ref_ptr<State> ret = static_cast<T*>(_action.get())->createState(session,
                                                                                           subactionPath);
-                    _states[subaction] = ret;
+                    _states.emplace_back(subaction, ret);
                     return ret.get();
                 }
             }
@@ -171,7 +233,7 @@ class ActionPrivateCommon : public Action::Private
 
     protected:
 
-        std::map<Subaction::Private *, osg::ref_ptr<State>> _states;
+        std::vector<std::pair<Subaction::Private *, osg::ref_ptr<State>>> _states;
 };
 
 template <typename T>
@@ -189,11 +251,80 @@ class ActionPrivateSimple : public ActionPrivateCommon<T>
         auto getValue(Subaction::Private *subaction)
         {
             State *state = this->getState(subaction);
-            if (state && state->update() && state->isActive())
+            if (!state)
+                return T::State::Info::defaultValue();
+
+            // Read from the bulk snapshot if the state was refreshed into it
+            const OpenXR::ActionStateSnapshot *snapshot = state->getSnapshot();
+            if (snapshot)
+            {
+                unsigned int slot = state->getSnapshotSlot();
+                if (snapshot->isActive(slot))
+                    return T::State::Info::fromVec2f(snapshot->getValue(slot));
+                return T::State::Info::defaultValue();
+            }
+
+            if (state->update() && state->isActive())
                 return state->getCurrentState();
             else
                 return T::State::Info::defaultValue();
         }
+
+        void generateEvents(std::vector<ActionEvent> &events) override
+        {
+            OpenXR::Session *session = ActionSet::Private::get(this->_actionSet)->getSession();
+            if (!session)
+                return;
+
+            typedef decltype(T::State::Info::defaultValue()) Value;
+            bool isBoolean = std::is_same<Value, bool>::value;
+            for (auto &source: this->_eventSources)
+            {
+                State *state = this->getState(source.subaction.get());
+                if (!state || !state->update())
+                    continue;
+
+                bool active = state->isActive();
+                Value value = active ? state->getCurrentState()
+                                     : T::State::Info::defaultValue();
+                bool on = active && eventOn(value, this->_eventThreshold);
+                if (on == source.on)
+                    continue;
+                source.on = on;
+
+                ActionEvent::Type type;
+                if (isBoolean)
+                    type = on ? ActionEvent::PRESS : ActionEvent::RELEASE;
+                else
+                    type = on ? ActionEvent::THRESHOLD_ABOVE
+                              : ActionEvent::THRESHOLD_BELOW;
+                // Deactivation doesn't count as a change of value
+                XrTime time = state->hasChangedSinceLastSync()
+                            ? state->getLastChangedTime()
+                            : session->getLastDisplayTime();
+                events.emplace_back(this->_public,
+                                    source.subaction ? source.subaction->getPathString()
+                                                     : std::string(),
+                                    type, toVec2f(value), time);
+            }
+        }
+
+    protected:
+
+        static osg::Vec2f toVec2f(bool value)
+        {
+            return osg::Vec2f(value ? 1.0f : 0.0f, 0.0f);
+        }
+
+        static osg::Vec2f toVec2f(float value)
+        {
+            return osg::Vec2f(value, 0.0f);
+        }
+
+        static osg::Vec2f toVec2f(const osg::Vec2f &value)
+        {
+            return value;
+        }
 };
 
 typedef ActionPrivateSimple<OpenXR::ActionBoolean>  ActionPrivateBoolean;
@@ -229,8 +360,9 @@ class ActionPrivatePose : public ActionPrivateCommon<OpenXR::ActionPose>
             {
                 OpenXR::Space::Location loc;
                 XrTime time = session->getLastDisplayTime();
-                bool ret = space->locate(session->getLocalSpace(time), time,
-                                         loc);
+                bool ret = session->locateSpace(space,
+                                                session->getLocalSpace(time),
+                                                time, loc);
                 pose = Pose((Pose::Flags)loc.getFlags(),
                             loc.getOrientation(),
                             loc.getPosition());
@@ -282,6 +414,7 @@ class ActionPrivateVibration : public ActionPrivateCommon<OpenXR::ActionVibratio
 Action::Action(Private *priv) :
     _private(priv)
 {
+    _private->setPublic(this);
 }
 
 Action::~Action()
@@ -331,6 +464,26 @@ void Action::getBoundSourcesLocalizedNames(uint32_t whichComponents,
     _private->getBoundSourcesLocalizedNames(whichComponents, names);
 }
 
+void Action::enableEvents(Subaction *subaction)
+{
+    _private->enableEvents(Subaction::Private::get(subaction));
+}
+
+void Action::disableEvents(Subaction *subaction)
+{
+    _private->disableEvents(Subaction::Private::get(subaction));
+}
+
+void Action::setEventThreshold(float threshold)
+{
+    _private->setEventThreshold(threshold);
+}
+
+float Action::getEventThreshold() const
+{
+    return _private->getEventThreshold();
+}
+
 // ActionBoolean
 
 ActionBoolean::ActionBoolean(ActionSet *actionSet) :
@@ -5,14 +5,17 @@
 #define OSGXR_ACTION 1
 
 #include <osgXR/Action>
+#include <osgXR/ActionEvent>
 
 #include "Subaction.h"
 
 #include <osg/ref_ptr>
 
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace osgXR {
 
@@ -67,6 +70,34 @@ class Action::Private
         void getBoundSourcesLocalizedNames(XrInputSourceLocalizedNameFlags whichComponents,
                                            std::vector<std::string> &names) const;
 
+        /// Invalidate cached bound sources, e.g. on interaction profile change.
+        void invalidateBoundSources();
+
+        // Events
+
+        /// Set the public object, for events to refer to.
+        void setPublic(Action *pub)
+        {
+            _public = pub;
+        }
+
+        void enableEvents(std::shared_ptr<Subaction::Private> subaction);
+        void disableEvents(std::shared_ptr<Subaction::Private> subaction);
+
+        void setEventThreshold(float threshold)
+        {
+            _eventThreshold = threshold;
+        }
+        float getEventThreshold() const
+        {
+            return _eventThreshold;
+        }
+
+        /// Generate events for changes since the last action sync.
+        virtual void generateEvents(std::vector<ActionEvent> &events)
+        {
+        }
+
     protected:
 
         std::string _name;
@@ -77,6 +108,25 @@ class Action::Private
 
         bool _updated;
         osg::ref_ptr<OpenXR::Action> _action;
+
+        // Bound sources cache
+        bool updateBoundSources() const;
+        mutable bool _boundSourcesValid;
+        mutable std::vector<XrPath> _boundSourcePaths;
+        mutable std::vector<std::string> _boundSources;
+        mutable std::map<XrInputSourceLocalizedNameFlags,
+                         std::vector<std::string>> _boundSourceNames;
+
+        // Events
+        Action *_public;
+        struct EventSource
+        {
+            std::shared_ptr<Subaction::Private> subaction;
+            // Whether pressed or above threshold at the last sync
+            bool on;
+        };
+        std::vector<EventSource> _eventSources;
+        float _eventThreshold;
 };
 
 } // osgXR
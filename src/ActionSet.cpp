@@ -113,6 +113,21 @@ void ActionSet::Private::unregisterAction(Action::Private *action)
     _actions.erase(action);
 }
 
+void ActionSet::Private::onInteractionProfileChanged()
+{
+    // Bindings may have changed
+    for (auto *action: _actions)
+        action->invalidateBoundSources();
+}
+
+void ActionSet::Private::generateEvents(std::vector<ActionEvent> &events)
+{
+    if (!_session.valid())
+        return;
+    for (auto *action: _actions)
+        action->generateEvents(events);
+}
+
 OpenXR::ActionSet *ActionSet::Private::setup(OpenXR::Instance *instance)
 {
     if (_updated)
@@ -6,6 +6,7 @@
 
 #include <osgXR/ActionSet>
 #include <osgXR/Action>
+#include <osgXR/ActionEvent>
 
 #include "OpenXR/Path.h"
 
@@ -17,6 +18,7 @@
 #include <memory>
 #include <string>
 #include <set>
+#include <vector>
 
 namespace osgXR {
 
@@ -59,6 +61,12 @@ class ActionSet::Private
         void registerAction(Action::Private *action);
         void unregisterAction(Action::Private *action);
 
+        /// Notify that an interaction profile has changed.
+        void onInteractionProfileChanged();
+
+        /// Generate events for actions since the last action sync.
+        void generateEvents(std::vector<ActionEvent> &events);
+
         /// Setup action set with an OpenXR instance
         OpenXR::ActionSet *setup(OpenXR::Instance *instance);
         /// Setup action set with an OpenXR session
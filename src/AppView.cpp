@@ -2,6 +2,8 @@
 // Copyright (C) 2024 James Hogan <james@albanarts.com>
 
 #include "AppView.h"
+#include "XRStateCallbacks.h"
+#include "projection.h"
 
 #include <osg/ViewportIndexed>
 
@@ -13,6 +15,7 @@ AppView::AppView(XRState *state,
     View(window, osgView),
     _valid(false),
     _state(state),
+    _resolutionScale(1.0f),
     _mvrWidth(1024),
     _mvrHeight(768),
     _mvrViews(1),
@@ -43,6 +46,7 @@ void AppView::destroy()
 
 void AppView::setCamFlags(osg::Camera* cam, View::Flags flags)
 {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_camMutex);
     auto it = _camFlags.find(cam);
     if (it == _camFlags.end())
         _camFlags.emplace(cam, flags);
@@ -50,16 +54,236 @@ void AppView::setCamFlags(osg::Camera* cam, View::Flags flags)
         it->second = (View::Flags)(it->second | flags);
 }
 
+void AppView::setupFinalDrawCallback(osg::Camera *camera)
+{
+    // Don't stack up callbacks if the camera is set up again
+    for (const osg::Callback *callback = camera->getFinalDrawCallback();
+         callback; callback = callback->getNestedCallback())
+        if (dynamic_cast<const FinalDrawCallback *>(callback))
+            return;
+    camera->addFinalDrawCallback(new FinalDrawCallback(_state));
+}
+
+void AppView::setupIdleCullCallback(osg::Camera *camera)
+{
+    // Don't stack up callbacks if the camera is set up again
+    for (const osg::Callback *callback = camera->getCullCallback();
+         callback; callback = callback->getNestedCallback())
+        if (dynamic_cast<const IdleCullCallback *>(callback))
+            return;
+    // It must come first so it can skip the other cull callbacks too
+    osg::ref_ptr<osg::Callback> callback = new IdleCullCallback(_state);
+    callback->setNestedCallback(camera->getCullCallback());
+    camera->setCullCallback(callback);
+}
+
 View::Flags AppView::getCamFlagsAndDrop(osg::Camera* cam)
 {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_camMutex);
     auto it = _camFlags.find(cam);
     if (it == _camFlags.end())
         return View::CAM_NO_BITS;
     View::Flags ret = it->second;
     _camFlags.erase(it);
+
+    // Restore the unscaled viewport
+    auto vpIt = _baseViewports.find(cam);
+    if (vpIt != _baseViewports.end())
+    {
+        const osg::Viewport *base = vpIt->second.get();
+        if (cam->getViewport())
+            cam->getViewport()->setViewport(base->x(), base->y(),
+                                            base->width(), base->height());
+        _baseViewports.erase(vpIt);
+    }
     return ret;
 }
 
+void AppView::setResolutionScale(float scale)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_camMutex);
+    bool changed = (scale != _resolutionScale);
+    _resolutionScale = scale;
+    rescaleCameras(changed);
+}
+
+void AppView::rescaleCameras(bool changed)
+{
+    for (auto &pair: _camFlags)
+    {
+        osg::Camera *camera = pair.first;
+        // Only touch cameras which are new or need rescaling
+        if (!changed && _baseViewports.count(camera))
+            continue;
+        const osg::Viewport *base = getBaseViewport(camera);
+        if (!base)
+            continue;
+
+        // Modify in place, osgXR forces it to be reapplied on draw
+        typedef OpenXR::SwapchainGroup::SubImage SubImage;
+        camera->getViewport()->setViewport(
+                SubImage::scaleCoord((uint32_t)base->x(), _resolutionScale),
+                SubImage::scaleCoord((uint32_t)base->y(), _resolutionScale),
+                SubImage::scaleCoord((uint32_t)base->width(), _resolutionScale),
+                SubImage::scaleCoord((uint32_t)base->height(), _resolutionScale));
+    }
+}
+
+const osg::Viewport *AppView::getBaseViewport(osg::Camera *camera)
+{
+    auto it = _baseViewports.find(camera);
+    if (it != _baseViewports.end())
+        return it->second.get();
+    if (!camera->getViewport())
+        return nullptr;
+    osg::ref_ptr<osg::Viewport> base = new osg::Viewport(*camera->getViewport());
+    _baseViewports[camera] = base;
+    return base.get();
+}
+
+AppView::ViewUniforms::ViewUniforms(XRState *state,
+                                    const std::vector<uint32_t> &viewIndices) :
+    _state(state),
+    _viewIndices(viewIndices)
+{
+}
+
+void AppView::ViewUniforms::addToStateSet(osg::StateSet *stateSet)
+{
+    if (!_transforms.valid())
+    {
+        _transforms = new osg::Uniform(osg::Uniform::FLOAT_MAT4,
+                                       "osgxr_transforms",
+                                       _viewIndices.size());
+        _viewMatrices = new osg::Uniform(osg::Uniform::FLOAT_MAT4,
+                                         "osgxr_view_matrices",
+                                         _viewIndices.size());
+        _normalMatrices = new osg::Uniform(osg::Uniform::FLOAT_MAT3,
+                                           "osgxr_normal_matrices",
+                                           _viewIndices.size());
+        for (uint32_t i = 0; i < _viewIndices.size(); ++i)
+        {
+            _transforms->setElement(i, osg::Matrix::identity());
+            _viewMatrices->setElement(i, osg::Matrix::identity());
+            _normalMatrices->setElement(i, osg::Matrix3(1.0, 0.0, 0.0,
+                                                        0.0, 1.0, 0.0,
+                                                        0.0, 0.0, 1.0));
+        }
+    }
+    stateSet->addUniform(_transforms);
+    stateSet->addUniform(_viewMatrices);
+    stateSet->addUniform(_normalMatrices);
+}
+
+osg::Uniform *AppView::ViewUniforms::getVisMaskProjections()
+{
+    if (!_visMaskProjections.valid())
+    {
+        _visMaskProjections = new osg::Uniform(osg::Uniform::FLOAT_MAT4,
+                                               "osgxr_visibility_mask_projections",
+                                               _viewIndices.size());
+        // Degenerate until the first frame is drawn
+        osg::Matrix zero(0.0, 0.0, 0.0, 0.0,
+                         0.0, 0.0, 0.0, 0.0,
+                         0.0, 0.0, 0.0, 0.0,
+                         0.0, 0.0, 0.0, 0.0);
+        for (uint32_t i = 0; i < _viewIndices.size(); ++i)
+            _visMaskProjections->setElement(i, zero);
+    }
+    return _visMaskProjections.get();
+}
+
+void AppView::ViewUniforms::calcView(const XrPosef &pose, const XrFovf *fov,
+                                     const osg::Matrix &sharedViewInv,
+                                     double zNear, double zFar,
+                                     osg::Matrix &viewOffset,
+                                     osg::Matrix &masterViewOffsetInv,
+                                     osg::Matrix &projMat) const
+{
+    osg::Vec3 position(pose.position.x,
+                       pose.position.y,
+                       pose.position.z);
+    osg::Quat orientation(pose.orientation.x,
+                          pose.orientation.y,
+                          pose.orientation.z,
+                          pose.orientation.w);
+
+    osg::Vec3 viewOffsetVec = position * _state->getUnitsPerMeter();
+    viewOffset.makeIdentity();
+    viewOffset.setTrans(viewOffsetVec);
+    viewOffset.preMultRotate(orientation);
+    masterViewOffsetInv = osg::Matrix::inverse(viewOffset);
+    viewOffset.postMult(sharedViewInv);
+
+    if (fov)
+        createProjectionFov(projMat, *fov, zNear, zFar);
+}
+
+void AppView::ViewUniforms::record(unsigned int frameNumber, bool validProj,
+                                   const osg::Matrix &sharedViewInv,
+                                   double zNear, double zFar)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+    Record &record = _records[frameNumber % numRecords];
+    record.valid = true;
+    record.frameNumber = frameNumber;
+    record.validProj = validProj;
+    record.sharedViewInv = sharedViewInv;
+    record.zNear = zNear;
+    record.zFar = zFar;
+}
+
+bool AppView::ViewUniforms::apply(OpenXR::Session::Frame *frame,
+                                  bool lateLatch)
+{
+    if (!_transforms.valid())
+        return false;
+
+    unsigned int frameNumber = frame->getOsgFrameNumber();
+    Record record;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+        record = _records[frameNumber % numRecords];
+    }
+    // Leave the uniforms alone if update didn't set up this frame
+    if (!record.valid || record.frameNumber != frameNumber)
+        return false;
+    // Late latching needs the projections redoing too
+    if (!record.validProj)
+        lateLatch = false;
+
+    for (uint32_t i = 0; i < _viewIndices.size(); ++i)
+    {
+        uint32_t viewIndex = _viewIndices[i];
+        const XrPosef &pose = lateLatch ? frame->getLateLatchedViewPose(viewIndex)
+                                        : frame->getViewPose(viewIndex);
+        const XrFovf *fov = nullptr;
+        if (record.validProj)
+            fov = lateLatch ? &frame->getLateLatchedViewFov(viewIndex)
+                            : &frame->getViewFov(viewIndex);
+
+        osg::Matrix viewOffset, masterViewOffsetInv, projMat;
+        calcView(pose, fov, record.sharedViewInv, record.zNear, record.zFar,
+                 viewOffset, masterViewOffsetInv, projMat);
+        osg::Matrix viewOffsetInv = osg::Matrix::inverse(viewOffset);
+
+        _viewMatrices->setElement(i, viewOffsetInv);
+        osg::Matrix3 normalMatrix(viewOffset(0,0), viewOffset(1, 0), viewOffset(2, 0),
+                                  viewOffset(0,1), viewOffset(1, 1), viewOffset(2, 1),
+                                  viewOffset(0,2), viewOffset(1, 2), viewOffset(2, 2));
+        _normalMatrices->setElement(i, normalMatrix);
+
+        if (fov)
+        {
+            _transforms->setElement(i, viewOffsetInv * projMat);
+            // Visibility masks are fixed relative to each view
+            if (_visMaskProjections.valid())
+                _visMaskProjections->setElement(i, projMat);
+        }
+    }
+    return lateLatch;
+}
+
 void AppView::setupIndexedViewports(osg::StateSet *stateSet,
                                     const std::vector<uint32_t> &viewIndices,
                                     uint32_t width, uint32_t height,
@@ -92,6 +316,153 @@ void AppView::setupIndexedViewports(osg::StateSet *stateSet,
             y = xrView->getSubImage().getY() * height / swapchainHeight;
             h = xrView->getSubImage().getHeight() * height / swapchainHeight;
         }
-        stateSet->setAttribute(new osg::ViewportIndexed(i, x, y, w, h));
+
+        // Scale for dynamic resolution
+        typedef OpenXR::SwapchainGroup::SubImage SubImage;
+        x = SubImage::scaleCoord(x, _resolutionScale);
+        y = SubImage::scaleCoord(y, _resolutionScale);
+        w = SubImage::scaleCoord(w, _resolutionScale);
+        h = SubImage::scaleCoord(h, _resolutionScale);
+
+        // Modify existing viewports in place when rescaling
+        auto *viewport = static_cast<osg::ViewportIndexed *>(
+                stateSet->getAttribute(osg::StateAttribute::VIEWPORTINDEXED, i));
+        if (viewport)
+            viewport->setViewport(x, y, w, h);
+        else
+            stateSet->setAttribute(new osg::ViewportIndexed(i, x, y, w, h));
+    }
+}
+
+void AppView::updateMultiViewSlave(osg::View &view,
+                                   osg::View::Slave &slave,
+                                   View::Flags flags,
+                                   unsigned int &lastUpdate,
+                                   const std::vector<uint32_t> &viewIndices,
+                                   MultiView *multiView,
+                                   ViewUniforms &viewUniforms,
+                                   MultiViewCullVisitor::Frustums *cullFrustums)
+{
+    // Find if we've already handled this frame
+    unsigned int frameNumber = view.getFrameStamp()->getFrameNumber();
+    bool newFrame = (lastUpdate != frameNumber);
+    lastUpdate = frameNumber;
+
+    bool setProjection = false;
+    osg::Matrix projectionMatrix;
+
+    OpenXR::Session::Frame *frame = _state->getFrame(view.getFrameStamp());
+    if (frame)
+    {
+        // Analyse frame
+        if (newFrame && multiView)
+            multiView->loadFrame(frame);
+
+        if (frame->isPositionValid() && frame->isOrientationValid())
+        {
+            double left, right, bottom, top, zNear, zFar;
+            bool validProj = view.getCamera()->getProjectionMatrixAsFrustum(
+                                                    left, right,
+                                                    bottom, top,
+                                                    zNear, zFar);
+
+            osg::Matrix sharedViewInv;
+            MultiView::SharedView sharedView;
+            if (multiView && multiView->getSharedView(sharedView))
+            {
+                osg::Vec3 position(sharedView.pose.position.x,
+                                   sharedView.pose.position.y,
+                                   sharedView.pose.position.z);
+                osg::Quat orientation(sharedView.pose.orientation.x,
+                                      sharedView.pose.orientation.y,
+                                      sharedView.pose.orientation.z,
+                                      sharedView.pose.orientation.w);
+                float zoffset = sharedView.zoffset * _state->getUnitsPerMeter();
+                // Inflate the culling frustum to allow for late latching
+                float cullMargin = _state->getLateLatchingCullMargin();
+                sharedView.fov.angleLeft -= cullMargin;
+                sharedView.fov.angleRight += cullMargin;
+                sharedView.fov.angleDown -= cullMargin;
+                sharedView.fov.angleUp += cullMargin;
+                osg::Vec3 sharedViewVec = position * _state->getUnitsPerMeter();
+                osg::Matrix sharedViewMatrix;
+                sharedViewMatrix.setTrans(sharedViewVec);
+                sharedViewMatrix.preMultRotate(orientation);
+                sharedViewInv = osg::Matrix::inverse(sharedViewMatrix);
+
+                // Used by updateSlaveImplementation() to update view matrix
+                if (flags & View::CAM_MVR_SCENE_BIT)
+                    slave._viewOffset = sharedViewInv;
+
+                if (validProj)
+                {
+                    createProjectionFov(projectionMatrix, sharedView.fov,
+                                        zNear + zoffset, zFar + zoffset);
+                    setProjection = true;
+                }
+            }
+            osg::Matrix sharedViewMatrix = osg::Matrix::inverse(sharedViewInv);
+            for (uint32_t i = 0; i < viewIndices.size(); ++i)
+            {
+                uint32_t viewIndex = viewIndices[i];
+                osg::Matrix viewOffset, masterViewOffsetInv, projMat;
+                viewUniforms.calcView(frame->getViewPose(viewIndex),
+                                      validProj ? &frame->getViewFov(viewIndex) : nullptr,
+                                      sharedViewInv, zNear, zFar,
+                                      viewOffset, masterViewOffsetInv, projMat);
+
+                if (validProj)
+                {
+                    if (cullFrustums)
+                    {
+                        // Inflated like the shared frustum for late latching
+                        XrFovf cullFov = frame->getViewFov(viewIndex);
+                        float cullMargin = _state->getLateLatchingCullMargin();
+                        cullFov.angleLeft -= cullMargin;
+                        cullFov.angleRight += cullMargin;
+                        cullFov.angleDown -= cullMargin;
+                        cullFov.angleUp += cullMargin;
+                        osg::Matrix cullProj;
+                        createProjectionFov(cullProj, cullFov, zNear, zFar);
+                        cullFrustums->setView(i, sharedViewMatrix *
+                                                 masterViewOffsetInv * cullProj);
+                    }
+
+                    View::Callback *cb = getCallback();
+                    if (cb)
+                    {
+                        XRState::XRView *xrView = _state->getView(viewIndex);
+                        XRState::AppSubView subview(xrView, masterViewOffsetInv, projMat);
+                        cb->updateSubView(this, i, subview);
+                    }
+                }
+            }
+
+            // The uniforms are written from this on draw
+            viewUniforms.record(frameNumber, validProj, sharedViewInv,
+                                zNear, zFar);
+        }
+    }
+
+    slave.updateSlaveImplementation(view);
+    if (setProjection && (flags & View::CAM_MVR_SCENE_BIT))
+        slave._camera->setProjectionMatrix(projectionMatrix);
+}
+
+void AppView::updateViewportUniforms(osg::Uniform *offsets,
+                                     osg::Uniform *scales,
+                                     const uint32_t *viewIndices,
+                                     unsigned int numViews)
+{
+    for (unsigned int i = 0; i < numViews; ++i)
+    {
+        XRState::XRView *xrView = _state->getView(viewIndices[i]);
+        auto subImage = xrView->getSubImage().scaled(_resolutionScale);
+        float width = xrView->getSwapchain()->getWidth();
+        float height = xrView->getSwapchain()->getHeight();
+        offsets->setElement(i, osg::Vec2(subImage.getX() / width,
+                                         subImage.getY() / height));
+        scales->setElement(i, osg::Vec2(subImage.getWidth() / width,
+                                        subImage.getHeight() / height));
     }
 }
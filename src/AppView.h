@@ -6,11 +6,17 @@
 
 #include <osgXR/View>
 
+#include "MultiView.h"
+#include "MultiViewCullVisitor.h"
 #include "XRState.h"
 
 #include <osg/Camera>
+#include <osg/Matrix>
+#include <osg/Uniform>
+#include <osg/Viewport>
 #include <osgViewer/GraphicsWindow>
 #include <osgViewer/View>
+#include <OpenThreads/Mutex>
 
 #include <cstdint>
 #include <map>
@@ -35,6 +41,29 @@ class AppView : public View
 
         void init();
 
+        /**
+         * Write per-view uniforms for a frame.
+         * Called from the draw thread before the first draw pass of a frame.
+         * @param frame    The frame about to be drawn.
+         * @param lateLatch Use the frame's late latched view locations.
+         * @return true if the late latched locations will be rendered.
+         */
+        virtual bool applyViewUniforms(OpenXR::Session::Frame *frame,
+                                       bool lateLatch)
+        {
+            return false;
+        }
+
+        /**
+         * Apply a dynamic resolution scale.
+         * Camera viewports are scaled towards the origin so that the views
+         * are rendered into a scaled region of the swapchain images.
+         * Called from the draw thread before the cameras of each frame are
+         * drawn, with the scale that frame was set up with, so that a frame
+         * still being drawn isn't rescaled by the update of the next.
+         */
+        void setResolutionScale(float scale);
+
         void setMVRSize(unsigned int width, unsigned int height)
         {
             _mvrWidth = width;
@@ -116,6 +145,90 @@ class AppView : public View
         }
 
     protected:
+        /**
+         * Per-view transform uniforms of multiview modes.
+         * The update traversal records the shared view each frame is set up
+         * with, and the uniforms are only written from the draw thread before
+         * the frame's first draw pass, as the previous frame may still be
+         * drawing while the next is updated.
+         */
+        class ViewUniforms
+        {
+            public:
+                ViewUniforms(XRState *state,
+                             const std::vector<uint32_t> &viewIndices);
+
+                /// Create the uniforms if necessary and add them to a stateset.
+                void addToStateSet(osg::StateSet *stateSet);
+
+                /**
+                 * Get the visibility mask projections uniform, creating it if
+                 * necessary, so that it is written along with the others.
+                 */
+                osg::Uniform *getVisMaskProjections();
+
+                /**
+                 * Calculate the matrices of a view.
+                 * @param viewOffset[out]          View relative to the shared view.
+                 * @param masterViewOffsetInv[out] View relative to the master view.
+                 * @param projMat[out]             Projection, if @p fov is set.
+                 */
+                void calcView(const XrPosef &pose, const XrFovf *fov,
+                              const osg::Matrix &sharedViewInv,
+                              double zNear, double zFar,
+                              osg::Matrix &viewOffset,
+                              osg::Matrix &masterViewOffsetInv,
+                              osg::Matrix &projMat) const;
+
+                /// Record how a frame was set up, from the update thread.
+                void record(unsigned int frameNumber, bool validProj,
+                            const osg::Matrix &sharedViewInv,
+                            double zNear, double zFar);
+
+                /**
+                 * Write the uniforms for a frame, from the draw thread.
+                 * @return true if late latched locations were written.
+                 */
+                bool apply(OpenXR::Session::Frame *frame, bool lateLatch);
+
+            protected:
+                XRState *_state;
+                std::vector<uint32_t> _viewIndices;
+
+                // osgxr_transforms[]
+                osg::ref_ptr<osg::Uniform> _transforms;
+                // osgxr_view_matrices[]
+                osg::ref_ptr<osg::Uniform> _viewMatrices;
+                // osgxr_normal_matrices[]
+                osg::ref_ptr<osg::Uniform> _normalMatrices;
+                // osgxr_visibility_mask_projections[]
+                osg::ref_ptr<osg::Uniform> _visMaskProjections;
+
+                // What update set up recent frames with (protected by _mutex)
+                struct Record
+                {
+                    Record() :
+                        valid(false),
+                        frameNumber(0),
+                        validProj(false),
+                        zNear(0.0),
+                        zFar(0.0)
+                    {
+                    }
+
+                    bool valid;
+                    unsigned int frameNumber;
+                    bool validProj;
+                    osg::Matrix sharedViewInv;
+                    double zNear;
+                    double zFar;
+                };
+                // Double buffered, one being updated while one is drawn
+                static constexpr unsigned int numRecords = 2;
+                OpenThreads::Mutex _mutex;
+                Record _records[numRecords];
+        };
+
         static int shaderStageToIndex(GLenum stage)
         {
             switch (stage) {
@@ -132,16 +245,70 @@ class AppView : public View
         void setCamFlags(osg::Camera* cam, View::Flags flags);
         View::Flags getCamFlagsAndDrop(osg::Camera* cam);
 
+        /// Get a mask of OpenXR view indices.
+        static uint32_t getViewMask(const std::vector<uint32_t> &viewIndices)
+        {
+            uint32_t mask = 0;
+            for (uint32_t viewIndex: viewIndices)
+                mask |= 1u << viewIndex;
+            return mask;
+        }
+
+        /// Add a final draw callback to end GPU timing of a camera.
+        void setupFinalDrawCallback(osg::Camera *camera);
+
+        /// Add a cull callback to skip a camera on frames not displayed.
+        void setupIdleCullCallback(osg::Camera *camera);
+
         /// Configure indexed viewports
         void setupIndexedViewports(osg::StateSet *stateSet,
                                    const std::vector<uint32_t> &viewIndices,
                                    uint32_t width, uint32_t height,
                                    View::Flags flags);
 
+        /**
+         * Update the scene camera slave of a single pass multiview mode.
+         * This sets the camera up to cull once against a shared frustum
+         * enclosing all the views, inflated for late latching, and records
+         * each view's transforms and cull frustum for the frame.
+         * @param lastUpdate[in,out] Number of the last frame handled.
+         * @param multiView         Shared view calculation, if any.
+         * @param cullFrustums      Per-view frustums for multiview culling,
+         *                          if enabled.
+         */
+        void updateMultiViewSlave(osg::View &view, osg::View::Slave &slave,
+                                  View::Flags flags, unsigned int &lastUpdate,
+                                  const std::vector<uint32_t> &viewIndices,
+                                  MultiView *multiView,
+                                  ViewUniforms &viewUniforms,
+                                  MultiViewCullVisitor::Frustums *cullFrustums);
+
+        /// Set MVR viewport offset & scale uniforms for each view.
+        void updateViewportUniforms(osg::Uniform *offsets,
+                                    osg::Uniform *scales,
+                                    const uint32_t *viewIndices,
+                                    unsigned int numViews);
+
+        /**
+         * Rescale the viewports of cameras for dynamic resolution.
+         * Called with _camMutex held.
+         * @param changed Whether the scale has changed, otherwise only new
+         *                cameras need rescaling.
+         */
+        virtual void rescaleCameras(bool changed);
+
+        /// Get the unscaled viewport of a camera.
+        const osg::Viewport *getBaseViewport(osg::Camera *camera);
+
         bool _valid;
 
         XRState *_state;
+        // Protects _camFlags & _baseViewports, used by update & draw threads
+        OpenThreads::Mutex _camMutex;
         std::map<osg::Camera*, View::Flags> _camFlags;
+        // Dynamic resolution
+        float _resolutionScale;
+        std::map<osg::Camera*, osg::ref_ptr<osg::Viewport> > _baseViewports;
         unsigned int _mvrWidth;
         unsigned int _mvrHeight;
         unsigned int _mvrViews;
@@ -3,8 +3,10 @@
 
 #include "AppViewGeomShaders.h"
 
+#include "MultiViewCullVisitor.h"
 #include "XRStateCallbacks.h"
-#include "projection.h"
+
+#include <osg/MatrixTransform>
 
 using namespace osgXR;
 
@@ -13,21 +15,27 @@ class AppViewGeomShaders::UpdateSlaveCallback : public osg::View::Slave::UpdateS
     public:
 
         UpdateSlaveCallback(AppViewGeomShaders *appView,
-                            View::Flags flags) :
+                            View::Flags flags,
+                            osg::MatrixTransform *visMaskTransform) :
             _appView(appView),
-            _flags(flags)
+            _flags(flags),
+            _visMaskTransform(visMaskTransform)
         {
         }
 
         void updateSlave(osg::View &view, osg::View::Slave &slave) override
         {
             _appView->updateSlave(view, slave, _flags);
+            if (_visMaskTransform.valid())
+                XRState::updateVisibilityMaskTransform(slave._camera,
+                                                        _visMaskTransform.get());
         }
 
     protected:
 
         osg::observer_ptr<AppViewGeomShaders> _appView;
         View::Flags _flags;
+        osg::observer_ptr<osg::MatrixTransform> _visMaskTransform;
 };
 
 AppViewGeomShaders::AppViewGeomShaders(XRState *state,
@@ -37,7 +45,8 @@ AppViewGeomShaders::AppViewGeomShaders(XRState *state,
     AppView(state, window, osgView),
     _viewIndices(viewIndices),
     _multiView(MultiView::create(state->getSession())),
-    _lastUpdate(0)
+    _lastUpdate(0),
+    _viewUniforms(state, viewIndices)
 {
     // Record how big MVR buffers should be
     XRState::XRView *xrView = _state->getView(_viewIndices[0]);
@@ -75,9 +84,31 @@ void AppViewGeomShaders::addSlave(osg::Camera *slaveCamera,
 
     if (flags & View::CAM_MVR_SCENE_BIT)
     {
+        osg::ref_ptr<osg::MatrixTransform> visMaskTransform;
+        // Set up visibility masks for all views of this slave camera
+        // The masks are projected per-view in shaders, but the transform is
+        // kept in range so it doesn't disturb near/far computation
+        if (_state->needsVisibilityMask(slaveCamera))
+        {
+            _state->setupMultiViewVisibilityMasks(slaveCamera, _viewIndices,
+                                                  XRState::VIS_MASK_ROUTE_GEOMETRY_SHADER,
+                                                  _viewUniforms.getVisMaskProjections(),
+                                                  visMaskTransform);
+        }
+
+        // Cull each view's frustum in the same traversal
+        if (_state->needsMultiViewCulling())
+        {
+            _cullFrustums = new MultiViewCullVisitor::Frustums(_viewIndices.size());
+            if (!MultiViewCullVisitor::install(slaveCamera, _viewIndices.size(),
+                                               _cullFrustums.get()))
+                _cullFrustums = nullptr;
+        }
+
         osg::View::Slave *slave = _osgView->findSlaveForCamera(slaveCamera);
-        // calls updateSlave() on update
-        slave->_updateSlaveCallback = new UpdateSlaveCallback(this, flags);
+        // calls updateSlave(), updateVisibilityMaskTransform() on update
+        slave->_updateSlaveCallback = new UpdateSlaveCallback(this, flags,
+                                                              visMaskTransform.get());
     }
 }
 
@@ -120,7 +151,10 @@ void AppViewGeomShaders::setupCamera(osg::Camera *camera, View::Flags flags)
 
     // This initial draw callback is used to disable normal OSG camera setup
     // which would undo our RTT FBO configuration, and start the frame.
-    camera->setInitialDrawCallback(new InitialDrawCallback(_state, flags));
+    camera->setInitialDrawCallback(new InitialDrawCallback(_state, flags,
+                                                           getViewMask(_viewIndices)));
+    setupFinalDrawCallback(camera);
+    setupIdleCullCallback(camera);
 
     if (flags & (View::CAM_MVR_SCENE_BIT))
         camera->setReferenceFrame(osg::Camera::RELATIVE_RF);
@@ -147,6 +181,17 @@ void AppViewGeomShaders::setupCamera(osg::Camera *camera, View::Flags flags)
             stateSet->setDefine("OSGXR_GEOM_TRANSFORM(POS)", "(osgxr_transforms[gl_InvocationID] * (POS))");
             stateSet->setDefine("OSGXR_GEOM_VIEW_MATRIX",    "osgxr_view_matrices[gl_InvocationID]");
             stateSet->setDefine("OSGXR_GEOM_NORMAL_MATRIX",  "osgxr_normal_matrices[gl_InvocationID]");
+            if (_state->needsMultiViewCulling())
+            {
+                // Set per-drawable by MultiViewCullVisitor
+                strGeomUniforms += "uniform int osgxr_view_mask;";
+                stateSet->setDefine("OSGXR_GEOM_VIEW_VISIBLE",
+                                    "((osgxr_view_mask & (1 << gl_InvocationID)) != 0)");
+            }
+            else
+            {
+                stateSet->setDefine("OSGXR_GEOM_VIEW_VISIBLE", "true");
+            }
         }
 
         if (flags & View::CAM_MVR_SHADING_BIT)
@@ -190,152 +235,62 @@ void AppViewGeomShaders::setupCamera(osg::Camera *camera, View::Flags flags)
         // Set up the indexed viewports
         setupIndexedViewports(stateSet, _viewIndices, width, height, flags);
 
-        // Set up uniforms for the geometry shader, to be set on update by
-        // updateSlave().
-        if (!_uniformTransforms.valid())
+        // Set up uniforms for the geometry shader, to be set on draw by
+        // applyViewUniforms().
+        _viewUniforms.addToStateSet(stateSet);
+        if (!_uniformViewportOffsets.valid())
         {
-            _uniformTransforms = new osg::Uniform(osg::Uniform::FLOAT_MAT4,
-                                                  "osgxr_transforms",
-                                                  _viewIndices.size());
-            _uniformViewMatrices = new osg::Uniform(osg::Uniform::FLOAT_MAT4,
-                                                    "osgxr_view_matrices",
-                                                    _viewIndices.size());
-            _uniformNormalMatrices = new osg::Uniform(osg::Uniform::FLOAT_MAT3,
-                                                      "osgxr_normal_matrices",
-                                                      _viewIndices.size());
             _uniformViewportOffsets = new osg::Uniform(osg::Uniform::FLOAT_VEC2,
                                                        "osgxr_viewport_offsets",
                                                        _viewIndices.size());
             _uniformViewportScales = new osg::Uniform(osg::Uniform::FLOAT_VEC2,
                                                       "osgxr_viewport_scales",
                                                       _viewIndices.size());
-            for (uint32_t i = 0; i < _viewIndices.size(); ++i)
-            {
-                XRState::XRView *xrView = _state->getView(_viewIndices[i]);
-                _uniformTransforms->setElement(i, osg::Matrix::identity());
-                _uniformViewMatrices->setElement(i, osg::Matrix::identity());
-                _uniformNormalMatrices->setElement(i, osg::Matrix3(1.0, 0.0, 0.0,
-                                                                   0.0, 1.0, 0.0,
-                                                                   0.0, 0.0, 1.0));
-                _uniformViewportOffsets->setElement(i,
-                    osg::Vec2((float)xrView->getSubImage().getX() / xrView->getSwapchain()->getWidth(),
-                              (float)xrView->getSubImage().getY() / xrView->getSwapchain()->getHeight()));
-                _uniformViewportScales->setElement(i,
-                    osg::Vec2((float)xrView->getSubImage().getWidth() / xrView->getSwapchain()->getWidth(),
-                              (float)xrView->getSubImage().getHeight() / xrView->getSwapchain()->getHeight()));
-            }
+            updateViewportUniforms(_uniformViewportOffsets,
+                                   _uniformViewportScales,
+                                   _viewIndices.data(), _viewIndices.size());
         }
-        stateSet->addUniform(_uniformTransforms);
-        stateSet->addUniform(_uniformViewMatrices);
-        stateSet->addUniform(_uniformNormalMatrices);
         stateSet->addUniform(_uniformViewportOffsets);
         stateSet->addUniform(_uniformViewportScales);
     }
 }
 
-void AppViewGeomShaders::updateSlave(osg::View &view,
-                                     osg::View::Slave &slave,
-                                     View::Flags flags)
+void AppViewGeomShaders::rescaleCameras(bool changed)
 {
-    // Find if we've already handled this frame
-    unsigned int frameNumber = view.getFrameStamp()->getFrameNumber();
-    bool newFrame = (_lastUpdate != frameNumber);
-    _lastUpdate = frameNumber;
+    AppView::rescaleCameras(changed);
+    if (!changed)
+        return;
 
-    bool setProjection = false;
-    osg::Matrix projectionMatrix;
-
-    osg::ref_ptr<OpenXR::Session::Frame> frame = _state->getFrame(view.getFrameStamp());
-    if (frame.valid())
+    // Rescale the indexed viewports of MVR cameras
+    for (auto &pair: _camFlags)
     {
-        // Analyse frame
-        if (newFrame && _multiView.valid())
-            _multiView->loadFrame(frame);
-
-        if (frame->isPositionValid() && frame->isOrientationValid())
-        {
-            double left, right, bottom, top, zNear, zFar;
-            bool validProj = view.getCamera()->getProjectionMatrixAsFrustum(
-                                                    left, right,
-                                                    bottom, top,
-                                                    zNear, zFar);
-
-            osg::Matrix sharedViewInv;
-            MultiView::SharedView sharedView;
-            if (_multiView.valid() && _multiView->getSharedView(sharedView))
-            {
-                osg::Vec3 position(sharedView.pose.position.x,
-                                   sharedView.pose.position.y,
-                                   sharedView.pose.position.z);
-                osg::Quat orientation(sharedView.pose.orientation.x,
-                                      sharedView.pose.orientation.y,
-                                      sharedView.pose.orientation.z,
-                                      sharedView.pose.orientation.w);
-                float zoffset = sharedView.zoffset * _state->getUnitsPerMeter();
-                osg::Vec3 sharedViewVec = position * _state->getUnitsPerMeter();
-                osg::Matrix sharedViewMatrix;
-                sharedViewMatrix.setTrans(sharedViewVec);
-                sharedViewMatrix.preMultRotate(orientation);
-                sharedViewInv = osg::Matrix::inverse(sharedViewMatrix);
-
-                // Used by updateSlaveImplementation() to update view matrix
-                if (flags & View::CAM_MVR_SCENE_BIT)
-                    slave._viewOffset = sharedViewInv;
-
-                if (validProj)
-                {
-                    createProjectionFov(projectionMatrix, sharedView.fov,
-                                        zNear + zoffset, zFar + zoffset);
-                    setProjection = true;
-                }
-            }
-            for (uint32_t i = 0; i < _viewIndices.size(); ++i)
-            {
-                uint32_t viewIndex = _viewIndices[i];
-                const auto &pose = frame->getViewPose(viewIndex);
-                osg::Vec3 position(pose.position.x,
-                                   pose.position.y,
-                                   pose.position.z);
-                osg::Quat orientation(pose.orientation.x,
-                                      pose.orientation.y,
-                                      pose.orientation.z,
-                                      pose.orientation.w);
-
-                osg::Matrix viewOffset;
-                osg::Vec3 viewOffsetVec = position * _state->getUnitsPerMeter();
-                viewOffset.setTrans(viewOffsetVec);
-                viewOffset.preMultRotate(orientation);
-                osg::Matrix masterViewOffsetInv = osg::Matrix::inverse(viewOffset);
-                viewOffset.postMult(sharedViewInv);
-                osg::Matrix viewOffsetInv = osg::Matrix::inverse(viewOffset);
-
-                _uniformViewMatrices->setElement(i, viewOffsetInv);
-                osg::Matrix3 normalMatrix(viewOffset(0,0), viewOffset(1, 0), viewOffset(2, 0),
-                                          viewOffset(0,1), viewOffset(1, 1), viewOffset(2, 1),
-                                          viewOffset(0,2), viewOffset(1, 2), viewOffset(2, 2));
-                _uniformNormalMatrices->setElement(i, normalMatrix);
-
-                if (validProj)
-                {
-                    const auto &fov = frame->getViewFov(viewIndex);
-                    osg::Matrix projMat, offsetProjMat;
-                    createProjectionFov(projMat, fov, zNear, zFar);
-                    offsetProjMat = viewOffsetInv * projMat;
-                    _uniformTransforms->setElement(i, offsetProjMat);
-
-                    View::Callback *cb = getCallback();
-                    if (cb)
-                    {
-                        XRState::XRView *xrView = _state->getView(viewIndex);
-                        XRState::AppSubView subview(xrView, masterViewOffsetInv, projMat);
-                        cb->updateSubView(this, i, subview);
-                    }
-                }
-            }
-        }
+        if (!(pair.second & (View::CAM_MVR_SCENE_BIT | View::CAM_MVR_SHADING_BIT)))
+            continue;
+        const osg::Viewport *base = getBaseViewport(pair.first);
+        osg::StateSet *stateSet = pair.first->getStateSet();
+        if (base && stateSet)
+            setupIndexedViewports(stateSet, _viewIndices,
+                                  base->width(), base->height(),
+                                  pair.second);
     }
 
-    slave.updateSlaveImplementation(view);
-    if (setProjection && (flags & View::CAM_MVR_SCENE_BIT))
-        slave._camera->setProjectionMatrix(projectionMatrix);
+    // And the MVR viewport uniforms
+    if (_uniformViewportOffsets.valid())
+        updateViewportUniforms(_uniformViewportOffsets,
+                               _uniformViewportScales,
+                               _viewIndices.data(), _viewIndices.size());
+}
+
+void AppViewGeomShaders::updateSlave(osg::View &view,
+                                     osg::View::Slave &slave,
+                                     View::Flags flags)
+{
+    updateMultiViewSlave(view, slave, flags, _lastUpdate, _viewIndices,
+                         _multiView, _viewUniforms, _cullFrustums);
+}
+
+bool AppViewGeomShaders::applyViewUniforms(OpenXR::Session::Frame *frame,
+                                           bool lateLatch)
+{
+    return _viewUniforms.apply(frame, lateLatch);
 }
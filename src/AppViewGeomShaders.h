@@ -6,7 +6,9 @@
 
 #include "AppView.h"
 #include "MultiView.h"
+#include "MultiViewCullVisitor.h"
 
+#include <osg/Matrix>
 #include <osg/Uniform>
 #include <osg/ref_ptr>
 
@@ -32,8 +34,15 @@ class AppViewGeomShaders : public AppView
 
         void setupCamera(osg::Camera *camera, View::Flags flags);
 
+        // AppView overrides
+        bool applyViewUniforms(OpenXR::Session::Frame *frame,
+                               bool lateLatch) override;
+
     protected:
 
+        // AppView overrides
+        void rescaleCameras(bool changed) override;
+
         // Slave update callback
 
         class UpdateSlaveCallback;
@@ -47,16 +56,15 @@ class AppViewGeomShaders : public AppView
         osg::ref_ptr<MultiView> _multiView;
         unsigned int _lastUpdate;
 
-        // osgxr_transforms[]
-        osg::ref_ptr<osg::Uniform> _uniformTransforms;
-        // osgxr_view_matrices[]
-        osg::ref_ptr<osg::Uniform> _uniformViewMatrices;
-        // osgxr_normal_matrices[]
-        osg::ref_ptr<osg::Uniform> _uniformNormalMatrices;
+        // osgxr_transforms[], osgxr_view_matrices[], osgxr_normal_matrices[]
+        ViewUniforms _viewUniforms;
         // osgxr_viewport_offsets[]
         osg::ref_ptr<osg::Uniform> _uniformViewportOffsets;
         // osgxr_viewport_scales[]
         osg::ref_ptr<osg::Uniform> _uniformViewportScales;
+
+        // Per-view frustums for multiview culling
+        osg::ref_ptr<MultiViewCullVisitor::Frustums> _cullFrustums;
 };
 
 
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "AppViewInstanced.h"
+
+using namespace osgXR;
+
+AppViewInstanced::AppViewInstanced(XRState *state,
+                                   const std::vector<uint32_t>& viewIndices,
+                                   osgViewer::GraphicsWindow *window,
+                                   osgViewer::View *osgView) :
+    AppViewVertexMultiview(state, viewIndices, window, osgView,
+                           XRState::VIS_MASK_ROUTE_INSTANCED, true,
+                           "(gl_InstanceID % " + std::to_string(viewIndices.size()) + ")",
+                           "gl_ViewportIndex",
+                           "#extension GL_ARB_fragment_layer_viewport : enable")
+{
+    // Record how per-view data should be indexed
+    setMVRViews(_viewIndices.size(), "",
+                _strVertView,
+                "0", // Geometry shaders aren't supported
+                "gl_ViewportIndex\n#extension GL_ARB_fragment_layer_viewport : enable");
+
+    // Record how many layers to use for MVR buffers
+    if (_state->getSwapchainMode() == Settings::SwapchainMode::SWAPCHAIN_LAYERED)
+        setMVRLayers(_viewIndices.size(), XRFramebuffer::ARRAY_INDEX_GEOMETRY,
+                     _strVertView,
+                     "0", // Geometry shaders aren't supported
+                     "gl_Layer\n#extension GL_ARB_fragment_layer_viewport : enable");
+    else
+        setMVRCells(_viewIndices.size());
+}
+
+void AppViewInstanced::setupViewRouting(osg::StateSet *stateSet,
+                                        View::Flags flags,
+                                        std::string &strVertLayout,
+                                        std::string &strVertExtensions,
+                                        std::string &strVertPrepareVertex)
+{
+    std::string strViews = std::to_string(_viewIndices.size());
+    bool single = (_state->getSwapchainMode() == Settings::SwapchainMode::SWAPCHAIN_SINGLE);
+
+    // Side by side cells of fixed size buffers
+    if (flags & View::CAM_MVR_SHADING_BIT)
+    {
+        if (single)
+        {
+            stateSet->setDefine("OSGXR_VERT_MVB_TEXCOORD(UV)",
+                                "((vec2(" + _strVertView + ", 0) + (UV)) / vec2(" + strViews + ", 1))");
+            stateSet->setDefine("OSGXR_FRAG_MVB_TEXCOORD(UV)",
+                                "((vec2(" + _strFragView + ", 0) + (UV)) / vec2(" + strViews + ", 1))"
+                                "\n" + _strFragExtensions);
+        }
+        else
+        {
+            stateSet->setDefine("OSGXR_VERT_MVB_TEXCOORD(UV)", "UV");
+        }
+    }
+
+    // Each view is drawn by its own instances
+    stateSet->setDefine("OSGXR_VERT_INSTANCE_ID", "(gl_InstanceID / " + strViews + ")");
+
+    if (_state->getSwapchainMode() == Settings::SwapchainMode::SWAPCHAIN_LAYERED)
+        strVertPrepareVertex += "gl_Layer = " + _strVertView + ";";
+}
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_APP_VIEW_INSTANCED
+#define OSGXR_APP_VIEW_INSTANCED 1
+
+#include "AppViewVertexMultiview.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osgXR {
+
+/// Represents an app level view in instanced stereo mode
+class AppViewInstanced : public AppViewVertexMultiview
+{
+    public:
+
+        AppViewInstanced(XRState *state,
+                         const std::vector<uint32_t> &viewIndices,
+                         osgViewer::GraphicsWindow *window,
+                         osgViewer::View *osgView);
+
+    protected:
+
+        // AppViewVertexMultiview overrides
+        void setupViewRouting(osg::StateSet *stateSet,
+                              View::Flags flags,
+                              std::string &strVertLayout,
+                              std::string &strVertExtensions,
+                              std::string &strVertPrepareVertex) override;
+};
+
+} // osgXR
+
+#endif
@@ -4,19 +4,16 @@
 #ifndef OSGXR_APP_VIEW_OVR_MULTIVIEW
 #define OSGXR_APP_VIEW_OVR_MULTIVIEW 1
 
-#include "AppView.h"
-#include "MultiView.h"
-
-#include <osg/Uniform>
-#include <osg/ref_ptr>
+#include "AppViewVertexMultiview.h"
 
 #include <cstdint>
+#include <string>
 #include <vector>
 
 namespace osgXR {
 
 /// Represents an app level view in OVR_multiview mode
-class AppViewOVRMultiview : public AppView
+class AppViewOVRMultiview : public AppViewVertexMultiview
 {
     public:
 
@@ -25,38 +22,14 @@ class AppViewOVRMultiview : public AppView
                             osgViewer::GraphicsWindow *window,
                             osgViewer::View *osgView);
 
-        // osgXR::View overrides
-        void addSlave(osg::Camera *slaveCamera,
-                      View::Flags flags) override;
-        void removeSlave(osg::Camera *slaveCamera) override;
-
-        void setupCamera(osg::Camera *camera, View::Flags flags);
-
     protected:
 
-        // Slave update callback
-
-        class UpdateSlaveCallback;
-
-        void updateSlave(osg::View& view, osg::View::Slave& slave,
-                         View::Flags flags);
-
-    protected:
-
-        std::vector<uint32_t> _viewIndices;
-        osg::ref_ptr<MultiView> _multiView;
-        unsigned int _lastUpdate;
-
-        // osgxr_transforms[]
-        osg::ref_ptr<osg::Uniform> _uniformTransforms;
-        // osgxr_view_matrices[]
-        osg::ref_ptr<osg::Uniform> _uniformViewMatrices;
-        // osgxr_normal_matrices[]
-        osg::ref_ptr<osg::Uniform> _uniformNormalMatrices;
-        // osgxr_viewport_offsets[]
-        osg::ref_ptr<osg::Uniform> _uniformViewportOffsets;
-        // osgxr_viewport_scales[]
-        osg::ref_ptr<osg::Uniform> _uniformViewportScales;
+        // AppViewVertexMultiview overrides
+        void setupViewRouting(osg::StateSet *stateSet,
+                              View::Flags flags,
+                              std::string &strVertLayout,
+                              std::string &strVertExtensions,
+                              std::string &strVertPrepareVertex) override;
 };
 
 } // osgXR
@@ -50,7 +50,9 @@ class AppViewSceneView::InitialDrawCallback : public osg::Camera::DrawCallback
         void operator()(osg::RenderInfo &renderInfo) const override
         {
             _appView->initialDraw(renderInfo, _flags);
-            _appView->_state->initialDrawCallback(renderInfo, _flags);
+            uint32_t viewMask = (1u << _appView->_viewIndices[0]) |
+                                (1u << _appView->_viewIndices[1]);
+            _appView->_state->initialDrawCallback(renderInfo, _flags, viewMask);
         }
 
         void releaseGLObjects(osg::State *state) const override
@@ -231,6 +233,8 @@ void AppViewSceneView::setupCamera(osg::Camera *camera, View::Flags flags)
     // This initial draw callback is used to disable normal OSG camera setup which
     // would undo our RTT FBO configuration.
     camera->setInitialDrawCallback(new InitialDrawCallback(this, flags));
+    setupFinalDrawCallback(camera);
+    setupIdleCullCallback(camera);
 
     osg::ref_ptr<osg::StateSet> stateSet = camera->getOrCreateStateSet();
     if (flags & (View::CAM_MVR_SCENE_BIT | View::CAM_MVR_SHADING_BIT))
@@ -288,16 +292,9 @@ void AppViewSceneView::setupCamera(osg::Camera *camera, View::Flags flags)
             _uniformViewportScales = new osg::Uniform(osg::Uniform::FLOAT_VEC2,
                                             "osgxr_viewport_scales",
                                             _state->getViewCount());
-            for (uint32_t i = 0; i < 2; ++i)
-            {
-                XRState::XRView *xrView = _state->getView(_viewIndices[i]);
-                _uniformViewportOffsets->setElement(i,
-                    osg::Vec2((float)xrView->getSubImage().getX() / xrView->getSwapchain()->getWidth(),
-                              (float)xrView->getSubImage().getY() / xrView->getSwapchain()->getHeight()));
-                _uniformViewportScales->setElement(i,
-                    osg::Vec2((float)xrView->getSubImage().getWidth() / xrView->getSwapchain()->getWidth(),
-                              (float)xrView->getSubImage().getHeight() / xrView->getSwapchain()->getHeight()));
-            }
+            updateViewportUniforms(_uniformViewportOffsets,
+                                   _uniformViewportScales,
+                                   _viewIndices, 2);
         }
         stateSet->addUniform(_uniformViewIndexPriv);
         stateSet->addUniform(_uniformViewportOffsets);
@@ -305,6 +302,18 @@ void AppViewSceneView::setupCamera(osg::Camera *camera, View::Flags flags)
     }
 }
 
+void AppViewSceneView::rescaleCameras(bool changed)
+{
+    AppView::rescaleCameras(changed);
+
+    // The SceneView splits the scaled camera viewport between the views, so
+    // only the MVR viewport uniforms need updating
+    if (changed && _uniformViewportOffsets.valid())
+        updateViewportUniforms(_uniformViewportOffsets,
+                               _uniformViewportScales,
+                               _viewIndices, 2);
+}
+
 void AppViewSceneView::updateSlave(osg::View &view,
                                    osg::View::Slave &slave)
 {
@@ -317,8 +326,8 @@ void AppViewSceneView::updateSlave(osg::View &view,
     }
     _lastUpdate = frameNumber;
 
-    osg::ref_ptr<OpenXR::Session::Frame> frame = _state->getFrame(view.getFrameStamp());
-    if (frame.valid())
+    OpenXR::Session::Frame *frame = _state->getFrame(view.getFrameStamp());
+    if (frame)
     {
         if (frame->isPositionValid() && frame->isOrientationValid())
         {
@@ -408,8 +417,8 @@ void AppViewSceneView::initialDraw(osg::RenderInfo &renderInfo,
 osg::Matrixd AppViewSceneView::getEyeProjection(osg::FrameStamp *stamp, int eye,
                                                 const osg::Matrixd &projection)
 {
-    osg::ref_ptr<OpenXR::Session::Frame> frame = _state->getFrame(stamp);
-    if (frame.valid())
+    OpenXR::Session::Frame *frame = _state->getFrame(stamp);
+    if (frame)
     {
         double left, right, bottom, top, zNear, zFar;
         if (projection.getFrustum(left, right,
@@ -428,8 +437,8 @@ osg::Matrixd AppViewSceneView::getEyeProjection(osg::FrameStamp *stamp, int eye,
 osg::Matrixd AppViewSceneView::getEyeView(osg::FrameStamp *stamp, int eye,
                                           const osg::Matrixd &view)
 {
-    osg::ref_ptr<OpenXR::Session::Frame> frame = _state->getFrame(stamp);
-    if (frame.valid())
+    OpenXR::Session::Frame *frame = _state->getFrame(stamp);
+    if (frame)
     {
         if (frame->isPositionValid() && frame->isOrientationValid())
         {
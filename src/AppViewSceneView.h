@@ -30,6 +30,9 @@ class AppViewSceneView : public AppView
 
     protected:
 
+        // AppView overrides
+        void rescaleCameras(bool changed) override;
+
         // Slave update callback
 
         class UpdateSlaveCallback;
@@ -3,6 +3,7 @@
 
 #include "AppViewSlaveCams.h"
 
+#include "VisibilityMaskCullCallback.h"
 #include "XRStateCallbacks.h"
 #include "projection.h"
 
@@ -76,6 +77,30 @@ void AppViewSlaveCams::addSlave(osg::Camera *slaveCamera,
         if (_state->needsVisibilityMask(slaveCamera))
             _state->setupVisibilityMask(slaveCamera, _viewIndex, visMaskTransform);
 
+        // Skip objects in the hidden corners of the view
+        if ((flags & View::CAM_MVR_SCENE_BIT) &&
+            _state->needsVisibilityMaskCulling())
+        {
+            auto cullCallback = VisibilityMaskCullCallback::create(_state->getSession(),
+                                                                   _viewIndex);
+            if (cullCallback.valid())
+                slaveCamera->addCullCallback(cullCallback);
+        }
+
+        // Share a single cull traversal between the views
+        SharedCull *sharedCull = _state->getSharedCull();
+        if ((flags & View::CAM_MVR_SCENE_BIT) && sharedCull)
+        {
+            // Keep this view's visibility mask out of the other views
+            if (visMaskTransform.valid())
+                visMaskTransform->addCullCallback(sharedCull->createPerViewCallback());
+            auto cullCallback = sharedCull->createCullCallback(slaveCamera,
+                                                               _viewIndex,
+                                                               visMaskTransform.get());
+            if (cullCallback.valid())
+                slaveCamera->addCullCallback(cullCallback);
+        }
+
         osg::View::Slave *slave = _osgView->findSlaveForCamera(slaveCamera);
         // Calls updateSlave(), updateVisibilityMaskTransform() on update
         slave->_updateSlaveCallback = new UpdateSlaveCallback(this, flags, visMaskTransform.get());
@@ -128,7 +153,10 @@ void AppViewSlaveCams::setupCamera(osg::Camera *camera, View::Flags flags)
 
     // This initial draw callback is used to disable normal OSG camera setup which
     // would undo our RTT FBO configuration.
-    camera->setInitialDrawCallback(new InitialDrawCallback(_state, flags));
+    camera->setInitialDrawCallback(new InitialDrawCallback(_state, flags,
+                                                           1u << _viewIndex));
+    setupFinalDrawCallback(camera);
+    setupIdleCullCallback(camera);
 }
 
 void AppViewSlaveCams::updateSlave(osg::View &view, osg::View::Slave &slave,
@@ -137,9 +165,13 @@ void AppViewSlaveCams::updateSlave(osg::View &view, osg::View::Slave &slave,
     bool setProjection = false;
     osg::Matrix projectionMatrix;
 
-    osg::ref_ptr<OpenXR::Session::Frame> frame = _state->getFrame(view.getFrameStamp());
-    if (frame.valid())
+    OpenXR::Session::Frame *frame = _state->getFrame(view.getFrameStamp());
+    if (frame)
     {
+        SharedCull *sharedCull = _state->getSharedCull();
+        if (sharedCull && (flags & View::CAM_MVR_SCENE_BIT))
+            sharedCull->update(view, frame, _state->getUnitsPerMeter());
+
         if (frame->isPositionValid() && frame->isOrientationValid())
         {
             const auto &pose = frame->getViewPose(_viewIndex);
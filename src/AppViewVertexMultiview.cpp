@@ -0,0 +1,283 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2024 James Hogan <james@albanarts.com>
+// Copyright (C) 2026 osgXR contributors
+
+#include "AppViewVertexMultiview.h"
+
+#include "MultiViewCullVisitor.h"
+#include "XRStateCallbacks.h"
+
+#include <osg/MatrixTransform>
+
+using namespace osgXR;
+
+class AppViewVertexMultiview::UpdateSlaveCallback : public osg::View::Slave::UpdateSlaveCallback
+{
+    public:
+
+        UpdateSlaveCallback(AppViewVertexMultiview *appView,
+                            View::Flags flags,
+                            osg::MatrixTransform *visMaskTransform) :
+            _appView(appView),
+            _flags(flags),
+            _visMaskTransform(visMaskTransform)
+        {
+        }
+
+        void updateSlave(osg::View &view, osg::View::Slave &slave) override
+        {
+            _appView->updateSlave(view, slave, _flags);
+            if (_visMaskTransform.valid())
+                XRState::updateVisibilityMaskTransform(slave._camera,
+                                                        _visMaskTransform.get());
+        }
+
+    protected:
+
+        osg::observer_ptr<AppViewVertexMultiview> _appView;
+        View::Flags _flags;
+        osg::observer_ptr<osg::MatrixTransform> _visMaskTransform;
+};
+
+AppViewVertexMultiview::AppViewVertexMultiview(XRState *state,
+                                               const std::vector<uint32_t>& viewIndices,
+                                               osgViewer::GraphicsWindow *window,
+                                               osgViewer::View *osgView,
+                                               XRState::VisibilityMaskRouting visMaskRoute,
+                                               bool instanceViews,
+                                               const std::string &strVertView,
+                                               const std::string &strFragView,
+                                               const std::string &strFragExtensions) :
+    AppView(state, window, osgView),
+    _viewIndices(viewIndices),
+    _visMaskRoute(visMaskRoute),
+    _instanceViews(instanceViews),
+    _strVertView(strVertView),
+    _strFragView(strFragView),
+    _strFragExtensions(strFragExtensions),
+    _multiView(MultiView::create(state->getSession())),
+    _lastUpdate(0),
+    _viewUniforms(state, viewIndices)
+{
+    // Record how big MVR buffers should be
+    XRState::XRView *xrView = _state->getView(_viewIndices[0]);
+    auto swapchainGroup = xrView->getSubImage().getSwapchainGroup();
+    setMVRSize(swapchainGroup->getWidth(),
+               swapchainGroup->getHeight());
+}
+
+void AppViewVertexMultiview::addSlave(osg::Camera *slaveCamera,
+                                      View::Flags flags)
+{
+    setCamFlags(slaveCamera, flags);
+
+    setupCamera(slaveCamera, flags);
+    if (flags & View::CAM_TOXR_BIT)
+    {
+        XRState::XRView *xrView = _state->getView(_viewIndices[0]);
+        xrView->getSwapchain()->incNumDrawPasses();
+    }
+
+    if (flags & View::CAM_MVR_SCENE_BIT)
+    {
+        osg::ref_ptr<osg::MatrixTransform> visMaskTransform;
+        // Set up visibility masks for all views of this slave camera
+        // The masks are projected per-view in shaders, but the transform is
+        // kept in range so it doesn't disturb near/far computation
+        if (_state->needsVisibilityMask(slaveCamera))
+        {
+            _state->setupMultiViewVisibilityMasks(slaveCamera, _viewIndices,
+                                                  _visMaskRoute,
+                                                  _viewUniforms.getVisMaskProjections(),
+                                                  visMaskTransform);
+        }
+
+        // Per-view frustums shared by all MVR scene cameras
+        if (_state->needsMultiViewCulling() && !_cullFrustums.valid())
+            _cullFrustums = new MultiViewCullVisitor::Frustums(_viewIndices.size());
+
+        osg::View::Slave *slave = _osgView->findSlaveForCamera(slaveCamera);
+        // calls updateSlave(), updateVisibilityMaskTransform() on update
+        slave->_updateSlaveCallback = new UpdateSlaveCallback(this, flags,
+                                                              visMaskTransform.get());
+    }
+
+    // Cull each view's frustum in the same traversal, and for instancing draw
+    // geometry with multiplied instances so each draw covers every view
+    MultiViewCullVisitor::Frustums *frustums = nullptr;
+    if (flags & View::CAM_MVR_SCENE_BIT)
+        frustums = _cullFrustums.get();
+    bool instanceViews = _instanceViews &&
+                         (flags & (View::CAM_MVR_SCENE_BIT | View::CAM_MVR_SHADING_BIT));
+    if (frustums || instanceViews)
+    {
+        if (!MultiViewCullVisitor::install(slaveCamera, _viewIndices.size(),
+                                           frustums, instanceViews) &&
+            instanceViews)
+            OSG_WARN << "osgXR: Instanced camera has no renderer, only the first view will be drawn" << std::endl;
+    }
+}
+
+void AppViewVertexMultiview::removeSlave(osg::Camera *slaveCamera)
+{
+    View::Flags flags = getCamFlagsAndDrop(slaveCamera);
+    if (flags & View::CAM_TOXR_BIT)
+    {
+        XRState::XRView *xrView = _state->getView(_viewIndices[0]);
+        xrView->getSwapchain()->decNumDrawPasses();
+    }
+}
+
+void AppViewVertexMultiview::setupCamera(osg::Camera *camera, View::Flags flags)
+{
+    XRState::XRView *xrView = _state->getView(_viewIndices[0]);
+    uint32_t width, height;
+    if (flags & View::CAM_TOXR_BIT)
+    {
+        camera->setRenderTargetImplementation(osg::Camera::FRAME_BUFFER_OBJECT);
+        camera->setDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
+        camera->setReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
+        width = xrView->getSwapchain()->getWidth();
+        height = xrView->getSwapchain()->getHeight();
+        camera->setViewport(0, 0, width, height);
+
+        // Here we avoid doing anything regarding OSG camera RTT attachment.
+        // Ideally we would use automatic methods within OSG for handling RTT
+        // but in this case it seemed simpler to handle FBO creation and
+        // selection within this class.
+
+        camera->setPreDrawCallback(new PreDrawCallback(xrView->getSwapchain()));
+        camera->setFinalDrawCallback(new PostDrawCallback(xrView->getSwapchain()));
+    }
+    else
+    {
+        width = camera->getViewport()->width();
+        height = camera->getViewport()->height();
+    }
+
+    // This initial draw callback is used to disable normal OSG camera setup
+    // which would undo our RTT FBO configuration, and start the frame.
+    camera->setInitialDrawCallback(new InitialDrawCallback(_state, flags,
+                                                           getViewMask(_viewIndices)));
+    setupFinalDrawCallback(camera);
+    setupIdleCullCallback(camera);
+
+    if (flags & (View::CAM_MVR_SCENE_BIT))
+        camera->setReferenceFrame(osg::Camera::RELATIVE_RF);
+
+    if (flags & (View::CAM_MVR_SCENE_BIT | View::CAM_MVR_SHADING_BIT))
+    {
+        osg::ref_ptr<osg::StateSet> stateSet = camera->getOrCreateStateSet();
+
+        std::string strViews = std::to_string(_viewIndices.size());
+        std::string strVertFragUniforms, strVertUniforms;
+        if (flags & View::CAM_MVR_SHADING_BIT)
+        {
+            // Vertex shader definitions
+            strVertFragUniforms += "uniform vec2 osgxr_viewport_offsets[" + strViews + "];"
+                                   "uniform vec2 osgxr_viewport_scales[" + strViews + "];";
+            stateSet->setDefine("OSGXR_VERT_MVR_TEXCOORD(UV)",
+                                "(osgxr_viewport_offsets[" + _strVertView + "] + (UV) * osgxr_viewport_scales[" + _strVertView + "])");
+
+            // Fragment shader definitions
+            stateSet->setDefine("OSGXR_FRAG_GLOBAL", strVertFragUniforms);
+            stateSet->setDefine("OSGXR_FRAG_MVR_TEXCOORD(UV)",
+                                "(osgxr_viewport_offsets[" + _strFragView + "] + (UV) * osgxr_viewport_scales[" + _strFragView + "])"
+                                "\n" + _strFragExtensions);
+        }
+        if (flags & View::CAM_MVR_SCENE_BIT) {
+            // Vertex shader definitions
+            strVertUniforms += "uniform mat4 osgxr_transforms[" + strViews + "];";
+            stateSet->setDefine("OSGXR_VERT_TRANSFORM(POS)",
+                                "(osgxr_transforms[" + _strVertView + "] * (osg_ModelViewMatrix * (POS)))");
+
+            strVertUniforms += "uniform mat4 osgxr_view_matrices[" + strViews + "];"
+                               "uniform mat3 osgxr_normal_matrices[" + strViews + "];";
+            stateSet->setDefine("OSGXR_VERT_VIEW_MATRIX", "osgxr_view_matrices[" + _strVertView + "]");
+            stateSet->setDefine("OSGXR_VERT_NORMAL_MATRIX", "osgxr_normal_matrices[" + _strVertView + "]");
+            if (_state->needsMultiViewCulling())
+            {
+                // Set per-drawable by MultiViewCullVisitor
+                strVertUniforms += "uniform int osgxr_view_mask;";
+                stateSet->setDefine("OSGXR_VERT_VIEW_VISIBLE",
+                                    "((osgxr_view_mask & (1 << int(" + _strVertView + "))) != 0)");
+            }
+            else
+            {
+                stateSet->setDefine("OSGXR_VERT_VIEW_VISIBLE", "true");
+            }
+        }
+
+        // Vertex shader definitions
+
+        std::string strVertLayout;
+        std::string strVertExtensions = "#extension GL_ARB_shader_viewport_layer_array : enable";
+        std::string strVertPrepareVertex = "gl_ViewportIndex = int(" + _strVertView + ");";
+        setupViewRouting(stateSet, flags, strVertLayout, strVertExtensions,
+                         strVertPrepareVertex);
+        stateSet->setDefine("OSGXR_VERT_GLOBAL", strVertLayout + strVertFragUniforms + strVertUniforms +
+                                                 "\n" + strVertExtensions);
+        stateSet->setDefine("OSGXR_VERT_PREPARE_VERTEX", "do {" + strVertPrepareVertex + "} while (false)");
+
+        // Set up the indexed viewports
+        setupIndexedViewports(stateSet, _viewIndices, width, height, flags);
+
+        // Set up uniforms for the vertex shader, to be set on draw by
+        // applyViewUniforms().
+        _viewUniforms.addToStateSet(stateSet);
+        if (!_uniformViewportOffsets.valid())
+        {
+            _uniformViewportOffsets = new osg::Uniform(osg::Uniform::FLOAT_VEC2,
+                                                       "osgxr_viewport_offsets",
+                                                       _viewIndices.size());
+            _uniformViewportScales = new osg::Uniform(osg::Uniform::FLOAT_VEC2,
+                                                      "osgxr_viewport_scales",
+                                                      _viewIndices.size());
+            updateViewportUniforms(_uniformViewportOffsets,
+                                   _uniformViewportScales,
+                                   _viewIndices.data(), _viewIndices.size());
+        }
+        stateSet->addUniform(_uniformViewportOffsets);
+        stateSet->addUniform(_uniformViewportScales);
+    }
+}
+
+void AppViewVertexMultiview::rescaleCameras(bool changed)
+{
+    AppView::rescaleCameras(changed);
+    if (!changed)
+        return;
+
+    // Rescale the indexed viewports of MVR cameras
+    for (auto &pair: _camFlags)
+    {
+        if (!(pair.second & (View::CAM_MVR_SCENE_BIT | View::CAM_MVR_SHADING_BIT)))
+            continue;
+        const osg::Viewport *base = getBaseViewport(pair.first);
+        osg::StateSet *stateSet = pair.first->getStateSet();
+        if (base && stateSet)
+            setupIndexedViewports(stateSet, _viewIndices,
+                                  base->width(), base->height(),
+                                  pair.second);
+    }
+
+    // And the MVR viewport uniforms
+    if (_uniformViewportOffsets.valid())
+        updateViewportUniforms(_uniformViewportOffsets,
+                               _uniformViewportScales,
+                               _viewIndices.data(), _viewIndices.size());
+}
+
+void AppViewVertexMultiview::updateSlave(osg::View &view,
+                                         osg::View::Slave &slave,
+                                         View::Flags flags)
+{
+    updateMultiViewSlave(view, slave, flags, _lastUpdate, _viewIndices,
+                         _multiView, _viewUniforms, _cullFrustums);
+}
+
+bool AppViewVertexMultiview::applyViewUniforms(OpenXR::Session::Frame *frame,
+                                               bool lateLatch)
+{
+    return _viewUniforms.apply(frame, lateLatch);
+}
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2024 James Hogan <james@albanarts.com>
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_APP_VIEW_VERTEX_MULTIVIEW
+#define OSGXR_APP_VIEW_VERTEX_MULTIVIEW 1
+
+#include "AppView.h"
+#include "MultiView.h"
+#include "MultiViewCullVisitor.h"
+
+#include <osg/Matrix>
+#include <osg/Uniform>
+#include <osg/ref_ptr>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osgXR {
+
+/**
+ * Common base of app level views drawing all views in a single pass, with the
+ * view chosen per vertex (OVR_multiview and instanced stereo).
+ * Derived classes provide the shader expressions for the current view and any
+ * further routing of vertices to views.
+ */
+class AppViewVertexMultiview : public AppView
+{
+    public:
+
+        // osgXR::View overrides
+        void addSlave(osg::Camera *slaveCamera,
+                      View::Flags flags) override;
+        void removeSlave(osg::Camera *slaveCamera) override;
+
+        void setupCamera(osg::Camera *camera, View::Flags flags);
+
+        // AppView overrides
+        bool applyViewUniforms(OpenXR::Session::Frame *frame,
+                               bool lateLatch) override;
+
+    protected:
+
+        /**
+         * Construct a vertex multiview app view.
+         * @param visMaskRoute      How visibility masks are routed to views.
+         * @param instanceViews     Whether geometry is drawn with an instance
+         *                          per view.
+         * @param strVertView       Vertex shader expression for the view.
+         * @param strFragView       Fragment shader expression for the view.
+         * @param strFragExtensions Fragment shader extensions needed by
+         *                          @p strFragView.
+         */
+        AppViewVertexMultiview(XRState *state,
+                               const std::vector<uint32_t> &viewIndices,
+                               osgViewer::GraphicsWindow *window,
+                               osgViewer::View *osgView,
+                               XRState::VisibilityMaskRouting visMaskRoute,
+                               bool instanceViews,
+                               const std::string &strVertView,
+                               const std::string &strFragView,
+                               const std::string &strFragExtensions);
+
+        /**
+         * Set up mode specific shader definitions of an MVR camera.
+         * @param strVertLayout        Vertex shader input layout, initially
+         *                             empty.
+         * @param strVertExtensions    Vertex shader extensions to add to.
+         * @param strVertPrepareVertex Vertex shader statements routing each
+         *                             vertex to its view's viewport, to add to.
+         */
+        virtual void setupViewRouting(osg::StateSet *stateSet,
+                                      View::Flags flags,
+                                      std::string &strVertLayout,
+                                      std::string &strVertExtensions,
+                                      std::string &strVertPrepareVertex) = 0;
+
+        // AppView overrides
+        void rescaleCameras(bool changed) override;
+
+        // Slave update callback
+
+        class UpdateSlaveCallback;
+
+        void updateSlave(osg::View& view, osg::View::Slave& slave,
+                         View::Flags flags);
+
+    protected:
+
+        std::vector<uint32_t> _viewIndices;
+        XRState::VisibilityMaskRouting _visMaskRoute;
+        bool _instanceViews;
+        std::string _strVertView;
+        std::string _strFragView;
+        std::string _strFragExtensions;
+        osg::ref_ptr<MultiView> _multiView;
+        unsigned int _lastUpdate;
+
+        // osgxr_transforms[], osgxr_view_matrices[], osgxr_normal_matrices[]
+        ViewUniforms _viewUniforms;
+        // osgxr_viewport_offsets[]
+        osg::ref_ptr<osg::Uniform> _uniformViewportOffsets;
+        // osgxr_viewport_scales[]
+        osg::ref_ptr<osg::Uniform> _uniformViewportScales;
+
+        // Per-view frustums for multiview culling
+        osg::ref_ptr<MultiViewCullVisitor::Frustums> _cullFrustums;
+};
+
+} // osgXR
+
+#endif
@@ -9,6 +9,7 @@
 #include "OpenXR/Compositor.h"
 
 #include "CompositionLayer.h"
+#include "ObjectPool.h"
 #include "Swapchain.h"
 
 using namespace osgXR;
@@ -120,13 +121,22 @@ class CompositionLayerPrivateQuad : public CompositionLayer::Private
             if (!swapchainPriv->released())
                 return;
 
-            _quadLayer = new OpenXR::CompositionLayerQuad();
+            // Recycle a layer which has been submitted if possible
+            _quadLayer = _quadLayerPool.getUnused();
+            if (!_quadLayer.valid())
+            {
+                _quadLayer = new OpenXR::CompositionLayerQuad();
+                _quadLayerPool.add(_quadLayer.get());
+            }
             if (writeCompositionLayerQuad(frame, _quadLayer))
                 frame->addLayer(_quadLayer.get());
         }
 
         void cleanupSession() override
         {
+            _quadLayer = nullptr;
+            _quadLayerPool.clear();
+
             Swapchain *swapchain = _subImage.getSwapchain();
             if (swapchain)
                 Swapchain::Private::get(swapchain)->cleanupSession();
@@ -141,6 +151,7 @@ class CompositionLayerPrivateQuad : public CompositionLayer::Private
         osg::Vec2f _size;
 
         osg::ref_ptr<OpenXR::CompositionLayerQuad> _quadLayer;
+        ObjectPool<OpenXR::CompositionLayerQuad> _quadLayerPool;
 };
 
 }
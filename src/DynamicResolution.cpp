@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace osgXR;
+
+// Fraction of the display period to aim to render within
+static const double frameBudget = 0.9;
+// Weight of each new measurement in the smoothed load
+static const double loadSmoothing = 0.1;
+// Most a single step may increase the scale by
+static const float maxStepUp = 1.05f;
+// Smallest scale change worth making
+static const float minStep = 0.01f;
+// Frames to ignore after a change, covering GPU timing readback latency
+static const unsigned int settleFrames = 10;
+
+DynamicResolution::DynamicResolution(float minScale, float maxScale,
+                                     float hysteresis) :
+    _minScale(std::max(0.1f, std::min(minScale, 1.0f))),
+    _maxScale(std::max(_minScale, std::min(maxScale, 1.0f))),
+    _hysteresis(hysteresis),
+    _scale(_maxScale),
+    _load(1.0),
+    _haveLoad(false),
+    _settleFrames(0)
+{
+}
+
+void DynamicResolution::update(double frameTime, double period)
+{
+    if (period <= 0.0 || frameTime <= 0.0)
+        return;
+
+    double load = frameTime / (period * frameBudget);
+    if (_haveLoad)
+        _load += (load - _load) * loadSmoothing;
+    else
+        _load = load;
+    _haveLoad = true;
+
+    if (_settleFrames)
+    {
+        --_settleFrames;
+        return;
+    }
+
+    // Render cost is roughly proportional to the number of pixels
+    float scale = getScale();
+    float newScale = scale;
+    if (_load > 1.0 + _hysteresis)
+        newScale = scale / std::sqrt(_load);
+    else if (_load < 1.0 - _hysteresis)
+        newScale = scale * std::min((float)std::sqrt(1.0 / _load), maxStepUp);
+    newScale = std::max(_minScale, std::min(newScale, _maxScale));
+
+    if (std::fabs(newScale - scale) >= minStep)
+    {
+        _scale.store(newScale, std::memory_order_relaxed);
+        // Predict the load at the new scale until measurements catch up
+        _load *= (newScale * newScale) / (scale * scale);
+        _settleFrames = settleFrames;
+    }
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_DYNAMIC_RESOLUTION
+#define OSGXR_DYNAMIC_RESOLUTION 1
+
+#include <osg/Referenced>
+
+#include <atomic>
+
+namespace osgXR {
+
+/**
+ * Chooses a rendering resolution scale from measured frame times.
+ * The scale applies to each view dimension, so render cost is assumed to be
+ * proportional to its square. update() is called from the draw thread at the
+ * end of each frame, and getScale() may be called from any thread.
+ */
+class DynamicResolution : public osg::Referenced
+{
+    public:
+
+        DynamicResolution(float minScale, float maxScale, float hysteresis);
+
+        /**
+         * Update the scale from the render time of a frame.
+         * @param frameTime Time taken to render the frame in seconds.
+         * @param period    Predicted display period in seconds.
+         */
+        void update(double frameTime, double period);
+
+        /// Get the current scale.
+        float getScale() const
+        {
+            return _scale.load(std::memory_order_relaxed);
+        }
+
+    protected:
+
+        float _minScale;
+        float _maxScale;
+        float _hysteresis;
+        std::atomic<float> _scale;
+
+        // Smoothed ratio of frame time to frame budget
+        double _load;
+        bool _haveLoad;
+        // Frames to wait for measurements to reflect a new scale
+        unsigned int _settleFrames;
+};
+
+} // osgXR
+
+#endif
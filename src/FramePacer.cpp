@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "FramePacer.h"
+
+#include <osg/Notify>
+
+using namespace osgXR;
+
+FramePacer::FramePacer(OpenXR::Session *session) :
+    _session(session),
+    _done(false)
+{
+}
+
+FramePacer::~FramePacer()
+{
+    stopPacing();
+}
+
+void FramePacer::startPacing()
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+        _done = false;
+    }
+    start();
+}
+
+void FramePacer::stopPacing()
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+        _done = true;
+        _cond.broadcast();
+    }
+    if (isRunning())
+        join();
+
+    // Drop any frame still waiting to be taken. Discarding it would begin it,
+    // which could discard a frame still being drawn, and the session is
+    // about to end anyway.
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+    _nextFrame = nullptr;
+}
+
+osg::ref_ptr<FramePacer::Frame> FramePacer::takeFrame()
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+    while (!_done && !_nextFrame.valid())
+        _cond.wait(&_mutex);
+
+    osg::ref_ptr<Frame> frame = _nextFrame;
+    _nextFrame = nullptr;
+    // Let the pacing thread wait for the following frame
+    _cond.broadcast();
+    return frame;
+}
+
+void FramePacer::run()
+{
+    for (;;)
+    {
+        {
+            // Only wait one frame ahead, xrWaitFrame would block on the
+            // previous frame being begun anyway
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+            while (!_done && _nextFrame.valid())
+                _cond.wait(&_mutex);
+            if (_done)
+                break;
+        }
+
+        osg::ref_ptr<Frame> frame = _session->waitFrame();
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+        if (!frame.valid())
+        {
+            OSG_WARN << "osgXR: Frame pacing thread stopping" << std::endl;
+            _done = true;
+            _cond.broadcast();
+            break;
+        }
+        _nextFrame = frame;
+        _cond.broadcast();
+    }
+}
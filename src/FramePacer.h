@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_FRAME_PACER
+#define OSGXR_FRAME_PACER 1
+
+#include "OpenXR/Session.h"
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <OpenThreads/Condition>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/Thread>
+
+namespace osgXR {
+
+/**
+ * Waits for OpenXR frames in a dedicated thread.
+ * A FramePacer owns xrWaitFrame for a running session, waiting for the next
+ * frame ahead of time so that the viewer can pick it up with takeFrame() as
+ * soon as it is needed, with the predicted display time already known.
+ *
+ * The pacing thread never binds the GL context, and xrWaitFrame isn't affected
+ * by any of the GL context quirks. It must however be stopped before the
+ * session is ended so that no XR calls remain in flight during teardown.
+ * Since xrWaitFrame won't return until the previous frame has been begun, any
+ * frames taken but not begun must be discarded before stopping it.
+ */
+class FramePacer : public osg::Referenced,
+                   public OpenThreads::Thread
+{
+    public:
+
+        typedef OpenXR::Session::Frame Frame;
+
+        FramePacer(OpenXR::Session *session);
+        virtual ~FramePacer();
+
+        /// Start the pacing thread.
+        void startPacing();
+        /**
+         * Stop the pacing thread and wait for it to finish.
+         * Frames already taken must have been begun or discarded, otherwise
+         * the pacing thread may never return from xrWaitFrame. A frame waited
+         * for but not yet taken is dropped without being begun, so the
+         * session should be ended afterwards.
+         */
+        void stopPacing();
+
+        /**
+         * Take the next waited frame, waiting for it if necessary.
+         * @return The frame, or nullptr if pacing has stopped.
+         */
+        osg::ref_ptr<Frame> takeFrame();
+
+    protected:
+
+        void run() override;
+
+        osg::ref_ptr<OpenXR::Session> _session;
+
+        // For access to _nextFrame and _done
+        OpenThreads::Mutex _mutex;
+        OpenThreads::Condition _cond;
+
+        // Protected by _mutex
+        osg::ref_ptr<Frame> _nextFrame;
+        bool _done;
+};
+
+}
+
+#endif
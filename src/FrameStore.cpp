@@ -4,50 +4,152 @@
 #include "FrameStore.h"
 
 #include <osg/FrameStamp>
+#include <osg/Notify>
 
 #include <cassert>
 
 using namespace osgXR;
 
-FrameStore::FrameStore()
+FrameStore::FrameStore() :
+    // 2 allows work to start on next frame before the prior one has ended
+    _maxFrames(2),
+    _waited(false),
+    _lastWaited(0)
 {
 }
 
-osg::ref_ptr<FrameStore::Frame> FrameStore::getFrame(FrameStore::Stamp stamp)
+bool FrameStore::setMaxFrames(unsigned int maxFrames)
 {
     OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
 
-    int index = lookupFrame(stamp);
-    if (index < 0)
-        return nullptr;
+    if (maxFrames < 1)
+        maxFrames = 1;
+    if (maxFrames > maxFramesLimit)
+    {
+        OSG_WARN << "osgXR: Limiting OpenXR frames in flight to "
+                 << maxFramesLimit << std::endl;
+        maxFrames = maxFramesLimit;
+    }
+    if (maxFrames == getMaxFrames())
+        return true;
+
+    // Frames can't be moved between ring slots while in flight. The ring
+    // itself stays put, so lock-free readers racing with this stay in bounds
+    // and simply won't find a frame.
+    for (auto &frame: _store)
+        if (frame.valid())
+            return false;
+    for (unsigned int i = 0; i < maxFramesLimit; ++i)
+    {
+        _published[i].frame.store(nullptr, std::memory_order_release);
+        _retired[i] = nullptr;
+    }
 
-    return _store[index];
+    _maxFrames.store(maxFrames, std::memory_order_relaxed);
+    return true;
 }
 
-osg::ref_ptr<FrameStore::Frame> FrameStore::getFrame(FrameStore::Stamp stamp,
-                                                     OpenXR::Session *session)
+void FrameStore::setFramePacer(FramePacer *pacer)
 {
     OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+    _pacer = pacer;
+}
 
-    int index = lookupFrame(stamp);
-    if (index < 0)
+FrameStore::Frame *FrameStore::getFrame(FrameStore::Stamp stamp) const
+{
+    unsigned int frameNumber = stamp->getFrameNumber();
+    const PublishedFrame &published = _published[ringIndex(frameNumber)];
+
+    // Pairs with the release in setFrame(), so the frame number is visible
+    Frame *frame = published.frame.load(std::memory_order_acquire);
+    if (frame && frame->getOsgFrameNumber() == frameNumber)
+        return frame;
+    return nullptr;
+}
+
+FrameStore::Frame *FrameStore::getFrame(FrameStore::Stamp stamp,
+                                        OpenXR::Session *session)
+{
+    // Only one thread waits for a new frame at a time, but other users of the
+    // store aren't held up by it
+    OpenThreads::ScopedLock<OpenThreads::Mutex> waitLock(_waitMutex);
+
+    unsigned int frameNumber = stamp->getFrameNumber();
+    unsigned int index;
+    osg::ref_ptr<FramePacer> pacer;
     {
-        index = blankFrame();
-        // there surely shouldn't be more than 2 frames in parallel
-        assert(index >= 0);
-        if (index < 0)
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+        // Another thread may have waited for it already
+        int found = lookupFrame(stamp);
+        if (found >= 0)
+            return _store[found].get();
+
+        // Don't associate a new frame with an old OSG frame
+        if (_waited && (int)(frameNumber - _lastWaited) <= 0)
             return nullptr;
 
-        osg::ref_ptr<OpenXR::Session::Frame> frame = session->waitFrame();
-        if (frame.valid())
+        index = ringIndex(frameNumber);
+        osg::ref_ptr<Frame> &slot = _store[index];
+        if (slot.valid())
         {
-            frame->setOsgFrameNumber(stamp->getFrameNumber());
-            _store[index] = frame;
+            // The slot is still occupied by an older frame
+            if (slot->hasBegun())
+            {
+                // It is still being drawn, so too many frames are in flight
+                OSG_WARN << "osgXR: Too many OpenXR frames in flight (max "
+                         << getMaxFrames() << "), frame " << frameNumber
+                         << " blocked by frame " << slot->getOsgFrameNumber()
+                         << std::endl;
+                return nullptr;
+            }
+
+            // It was waited for but never begun (e.g. its draw was skipped),
+            // and the runtime won't let another frame be waited for until it
+            // is begun. Beginning it would discard an earlier frame that is
+            // still being drawn though.
+            if (anyFrameBegun())
+                return nullptr;
+
+            OSG_WARN << "osgXR: Discarding stale OpenXR frame "
+                     << slot->getOsgFrameNumber() << " which was never begun"
+                     << std::endl;
+            slot->discard();
+            setFrame(index, nullptr);
         }
-        return frame;
+
+        pacer = _pacer;
     }
 
-    return _store[index];
+    // Wait without holding _mutex, as that would block frames being begun and
+    // ended, which the runtime may be waiting for
+    osg::ref_ptr<Frame> frame;
+    if (pacer.valid())
+        frame = pacer->takeFrame();
+    else
+        frame = session->waitFrame();
+    if (frame.valid())
+    {
+        // Must be set before the frame is published
+        frame->setOsgFrameNumber(frameNumber);
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+        setFrame(index, frame.get());
+        _waited = true;
+        _lastWaited = frameNumber;
+    }
+    return frame.get();
+}
+
+bool FrameStore::beginFrame(FrameStore::Stamp stamp)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+    int index = lookupFrame(stamp);
+    if (index < 0 || _store[index]->hasBegun())
+        return false;
+
+    return _store[index]->begin();
 }
 
 bool FrameStore::endFrame(FrameStore::Stamp stamp)
@@ -59,12 +161,12 @@ bool FrameStore::endFrame(FrameStore::Stamp stamp)
         return false;
 
     _store[index]->end();
-    _store[index] = nullptr;
+    setFrame(index, nullptr);
 
     return true;
 }
 
-bool FrameStore::killFrame(FrameStore::Stamp stamp)
+bool FrameStore::discardFrame(FrameStore::Stamp stamp)
 {
     OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
 
@@ -72,38 +174,74 @@ bool FrameStore::killFrame(FrameStore::Stamp stamp)
     if (index < 0)
         return false;
 
-    _store[index] = nullptr;
+    // Even if this fails the frame can't be used any more
+    bool ret = _store[index]->discard();
+    setFrame(index, nullptr);
+
+    return ret;
+}
+
+bool FrameStore::discardUnbegunFrames()
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+    if (anyFrameBegun())
+        return false;
 
+    for (unsigned int index = 0; index < maxFramesLimit; ++index)
+    {
+        if (_store[index].valid() && !_store[index]->hasBegun())
+        {
+            _store[index]->discard();
+            setFrame(index, nullptr);
+        }
+    }
     return true;
 }
 
 unsigned int FrameStore::countFrames() const
 {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
     unsigned int ret = 0;
-    for (unsigned int i = 0; i < maxFrames; ++i)
-        if (_store[i].valid())
+    for (auto &frame: _store)
+        if (frame.valid())
             ++ret;
     return ret;
 }
 
+bool FrameStore::anyFrameBegun() const
+{
+    for (auto &frame: _store)
+        if (frame.valid() && frame->hasBegun())
+            return true;
+    return false;
+}
+
 int FrameStore::lookupFrame(FrameStore::Stamp stamp) const
 {
     unsigned int frameNumber = stamp->getFrameNumber();
-    for (unsigned int i = 0; i < maxFrames; ++i)
+    unsigned int index = ringIndex(frameNumber);
+    if (_store[index].valid() &&
+        _store[index]->getOsgFrameNumber() == frameNumber)
     {
-        if (_store[i].valid() &&
-            _store[i]->getOsgFrameNumber() == frameNumber)
-        {
-            return i;
-        }
+        return index;
     }
     return -1;
 }
 
-int FrameStore::blankFrame() const
+void FrameStore::setFrame(unsigned int index, Frame *frame)
 {
-    for (unsigned int i = 0; i < maxFrames; ++i)
-        if (!_store[i].valid())
-            return i;
-    return -1;
+    _published[index].frame.store(frame, std::memory_order_release);
+    if (frame)
+    {
+        // Readers of the previous frame in this slot are long finished
+        _retired[index] = nullptr;
+    }
+    else
+    {
+        // Lock-free readers may still be using it until the slot is reused
+        _retired[index] = _store[index];
+    }
+    _store[index] = frame;
 }
@@ -4,12 +4,13 @@
 #ifndef OSGXR_FRAME_STORE
 #define OSGXR_FRAME_STORE 1
 
+#include "FramePacer.h"
 #include "OpenXR/Session.h"
 
 #include <osg/ref_ptr>
 #include <OpenThreads/Mutex>
 
-#include <vector>
+#include <atomic>
 
 namespace osg {
     class FrameStamp;
@@ -21,6 +22,18 @@ namespace osgXR {
  * Manages concurrent frames.
  * A FrameStore stores any concurrent OpenXR frames and allows them to be
  * created and retrieved in a thread-safe way based on an osg::FrameStamp.
+ * Frames are kept in a ring indexed by OSG frame number, so the number of
+ * frames that can be in flight at once is configurable (up to maxFramesLimit).
+ * The ring is allocated once and never reallocated, so it can be read while
+ * the viewer threads are running.
+ *
+ * Frames are also published lock-free so that lookups of existing frames from
+ * cull and draw threads never contend or write to shared memory, and the mutex
+ * is only needed for modifications. Waiting for new frames is serialised separately so that it
+ * never blocks other users of the store.
+ *
+ * Every waited frame is begun and ended, even if it isn't drawn, since the
+ * runtime won't return from xrWaitFrame until the previous frame is begun.
  */
 class FrameStore
 {
@@ -29,13 +42,51 @@ class FrameStore
         typedef OpenXR::Session::Frame Frame;
         typedef const osg::FrameStamp *Stamp;
 
+        /// Upper limit of setMaxFrames().
+        static constexpr unsigned int maxFramesLimit = 8;
+
         FrameStore();
 
-        /// Get a frame by FrameStamp.
-        osg::ref_ptr<Frame> getFrame(Stamp stamp);
+        /**
+         * Set the maximum number of concurrent frames.
+         * The store can't be resized while frames are in flight.
+         * @return true on success, false if frames are still in flight.
+         */
+        bool setMaxFrames(unsigned int maxFrames);
+        /// Get the maximum number of concurrent frames.
+        unsigned int getMaxFrames() const
+        {
+            return _maxFrames.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Set a frame pacer to take waited frames from.
+         * When set, new frames are taken from the pacer's thread rather than
+         * calling Session::waitFrame() directly.
+         */
+        void setFramePacer(FramePacer *pacer);
+
+        /**
+         * Get a frame by FrameStamp (lock-free).
+         * The store keeps the frame alive until its ring slot is reused by a
+         * later frame, so the returned pointer can be used without taking a
+         * reference while handling the OSG frame it was looked up for.
+         */
+        Frame *getFrame(Stamp stamp) const;
 
-        /// Get or wait for a frame by FrameStamp.
-        osg::ref_ptr<Frame> getFrame(Stamp stamp, OpenXR::Session *session);
+        /**
+         * Get or wait for a frame by FrameStamp.
+         * Frames older than the most recently waited frame are never waited
+         * for, and nullptr is returned if the frame can't be waited for yet.
+         * The returned frame has the same lifetime as from getFrame(stamp).
+         */
+        Frame *getFrame(Stamp stamp, OpenXR::Session *session);
+
+        /**
+         * Begin a frame by FrameStamp if it hasn't already been begun.
+         * @return true if the frame was begun by this call, false otherwise.
+         */
+        bool beginFrame(Stamp stamp);
 
         /**
          * End a frame by FrameStamp.
@@ -44,27 +95,73 @@ class FrameStore
         bool endFrame(Stamp stamp);
 
         /**
-         * Kill (without ending) a frame by FrameStamp.
+         * Discard a frame by FrameStamp, ending it without any layers.
          * @return true on success, false otherwise.
          */
-        bool killFrame(Stamp stamp);
+        bool discardFrame(Stamp stamp);
+
+        /**
+         * Discard all frames which have been waited for but not begun.
+         * A frame pacing thread won't return from xrWaitFrame until the frames
+         * it has handed out are begun, so this must be done before it can be
+         * stopped. Discarding a frame begins it, which would make the runtime
+         * discard any frame still being drawn, so nothing is done while a
+         * frame is begun.
+         * @return true if discarded, false if a frame is still begun.
+         */
+        bool discardUnbegunFrames();
 
         /// Count the number of frames.
         unsigned int countFrames() const;
 
     protected:
 
-        // These return cache index or -1
+        // Returns ring index or -1
         int lookupFrame(Stamp stamp) const;
-        int blankFrame() const;
 
-        // 2 allows work to start on next frame before the prior one has ended
-        static constexpr unsigned int maxFrames = 2;
+        // Ring index for an OSG frame number
+        unsigned int ringIndex(unsigned int frameNumber) const
+        {
+            return frameNumber % _maxFrames.load(std::memory_order_relaxed);
+        }
+
+        // Set or clear a ring slot, _mutex must be held
+        void setFrame(unsigned int index, Frame *frame);
+
+        // Find whether any frame is begun and not ended, _mutex must be held
+        bool anyFrameBegun() const;
+
+        // Lock-free publication of a ring slot, on its own cache line
+        struct alignas(64) PublishedFrame
+        {
+            // Raw pointer to the frame owned by _store
+            std::atomic<Frame *> frame;
+
+            PublishedFrame() :
+                frame(nullptr)
+            {
+            }
+        };
+
+        // Read lock-free, only changed with no frames in flight
+        std::atomic<unsigned int> _maxFrames;
+
         // Protected by _mutex
-        osg::ref_ptr<Frame> _store[maxFrames];
+        osg::ref_ptr<FramePacer> _pacer;
+        osg::ref_ptr<Frame> _store[maxFramesLimit];
+        // Frames which have been ended, kept alive for lock-free readers until
+        // the slot is reused
+        osg::ref_ptr<Frame> _retired[maxFramesLimit];
+        // Most recently waited OSG frame number
+        bool _waited;
+        unsigned int _lastWaited;
+        // Written with _mutex held, read lock-free
+        PublishedFrame _published[maxFramesLimit];
 
         // For access to _store
-        OpenThreads::Mutex _mutex;
+        mutable OpenThreads::Mutex _mutex;
+        // Held while waiting for a new frame
+        OpenThreads::Mutex _waitMutex;
 };
 
 }
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "FrameTimer.h"
+
+using namespace osgXR;
+
+FrameTimer::FrameTimer() :
+    _next(0),
+    _count(0),
+    _missedFrames(0),
+    _lastDisplayTime(0)
+{
+}
+
+void FrameTimer::reset()
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+    _next = 0;
+    _count = 0;
+    _missedFrames = 0;
+    _lastDisplayTime = 0;
+}
+
+void FrameTimer::record(const Record &record)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+    // Detect display periods skipped since the last frame
+    if (_lastDisplayTime && record.predictedDisplayPeriod > 0)
+    {
+        int64_t elapsed = record.predictedDisplayTime - _lastDisplayTime;
+        // Round to the nearest number of periods
+        int64_t periods = (elapsed + record.predictedDisplayPeriod / 2) /
+                          record.predictedDisplayPeriod;
+        if (periods > 1)
+            _missedFrames += periods - 1;
+    }
+    _lastDisplayTime = record.predictedDisplayTime;
+
+    _records[_next] = record;
+    _next = (_next + 1) % maxRecords;
+    if (_count < maxRecords)
+        ++_count;
+}
+
+void FrameTimer::snapshot(FrameTimings &timings) const
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+    // Oldest first
+    unsigned int first = (_next + maxRecords - _count) % maxRecords;
+    for (unsigned int i = 0; i < _count; ++i)
+        timings._addRecord(_records[(first + i) % maxRecords]);
+    timings._setMissedFrames(_missedFrames);
+}
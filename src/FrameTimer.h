@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_FRAME_TIMER
+#define OSGXR_FRAME_TIMER 1
+
+#include <osgXR/FrameTimings>
+
+#include <OpenThreads/Mutex>
+
+#include <cstdint>
+
+namespace osgXR {
+
+/**
+ * Records per-frame timings into a fixed size ring buffer.
+ * Recording doesn't allocate, so it can remain enabled all the time.
+ */
+class FrameTimer
+{
+    public:
+
+        typedef FrameTimings::Record Record;
+
+        /// Maximum number of frame records retained.
+        static constexpr unsigned int maxRecords = 256;
+
+        FrameTimer();
+
+        /// Forget all records, e.g. when a new session begins.
+        void reset();
+
+        /// Record the timings of a frame.
+        void record(const Record &record);
+
+        /// Take a snapshot of the recorded timings.
+        void snapshot(FrameTimings &timings) const;
+
+    protected:
+
+        // For access to everything below
+        mutable OpenThreads::Mutex _mutex;
+
+        Record _records[maxRecords];
+        unsigned int _next;
+        unsigned int _count;
+
+        unsigned int _missedFrames;
+        int64_t _lastDisplayTime;
+};
+
+}
+
+#endif
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include <osgXR/FrameTimings>
+
+#include <algorithm>
+
+using namespace osgXR;
+
+// Public API
+
+FrameTimings::FrameTimings() :
+    _missedFrames(0),
+    _hasGpuRecord(false),
+    _gpuRecord({ 0, {}, {}, 0.0, 0.0, 0.0 })
+{
+}
+
+FrameTimings::Stats FrameTimings::getStats(Phase phase) const
+{
+    Stats stats = { 0.0, 0.0, 0.0 };
+    if (_records.empty())
+        return stats;
+
+    std::vector<double> durations;
+    durations.reserve(_records.size());
+    double total = 0.0;
+    for (auto &record: _records)
+    {
+        durations.push_back(record.durations[phase]);
+        total += record.durations[phase];
+    }
+    std::sort(durations.begin(), durations.end());
+
+    stats.min = durations.front();
+    stats.avg = total / durations.size();
+    stats.p99 = durations[(durations.size() - 1) * 99 / 100];
+    return stats;
+}
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "GpuTimer.h"
+
+#include <osg/FrameStamp>
+#include <osg/GLExtensions>
+#include <osg/Notify>
+
+#include <OpenThreads/ScopedLock>
+
+#include <utility>
+
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+#ifndef GL_TIMESTAMP
+#define GL_TIMESTAMP 0x8E28
+#endif
+
+using namespace osgXR;
+
+GpuTimer::GpuTimer() :
+    _current(0),
+    _measuring(false),
+    _frameNumber(0),
+    _firstFrame(true),
+    _supported(false),
+    _checkedSupport(false),
+    _hasResult(false),
+    _result({ 0, {}, {}, 0.0, 0.0, 0.0 }),
+    _scratch({ 0, {}, {}, 0.0, 0.0, 0.0 })
+{
+    for (auto &slot: _slots)
+    {
+        slot.frameNumber = 0;
+        slot.pending = false;
+        slot.lastQuery = 0;
+    }
+}
+
+GpuTimer::~GpuTimer()
+{
+}
+
+int GpuTimer::beginSpan(osg::State &state, Target target, uint32_t viewMask,
+                        View::Flags flags)
+{
+    const auto *ext = state.get<osg::GLExtensions>();
+    if (!_checkedSupport)
+    {
+        _supported = ext->isARBTimerQuerySupported;
+        if (!_supported)
+            OSG_WARN << "osgXR: GL timer queries not supported, GPU timing will be disabled" << std::endl;
+        _checkedSupport = true;
+    }
+    if (!_supported || !state.getFrameStamp())
+        return -1;
+
+    unsigned int frameNumber = state.getFrameStamp()->getFrameNumber();
+    if (_firstFrame || frameNumber != _frameNumber)
+    {
+        nextFrame(state, frameNumber);
+        _frameNumber = frameNumber;
+        _firstFrame = false;
+    }
+    if (!_measuring)
+        return -1;
+
+    Slot &slot = _slots[_current];
+    unsigned int span = slot.spans.size();
+    slot.spans.push_back({ target, viewMask, flags, false });
+
+    // Grow the query pool if necessary, they're reused on later frames
+    unsigned int numQueries = slot.queries.size();
+    if (numQueries < (span + 1) * 2)
+    {
+        slot.queries.resize((span + 1) * 2);
+        ext->glGenQueries(slot.queries.size() - numQueries,
+                          &slot.queries[numQueries]);
+    }
+
+    slot.lastQuery = slot.queries[span * 2];
+    ext->glQueryCounter(slot.lastQuery, GL_TIMESTAMP);
+    slot.pending = true;
+    return span;
+}
+
+void GpuTimer::endSpan(osg::State &state, int span)
+{
+    if (span < 0 || !_measuring)
+        return;
+
+    Slot &slot = _slots[_current];
+    if ((unsigned int)span >= slot.spans.size())
+        return;
+
+    const auto *ext = state.get<osg::GLExtensions>();
+    slot.lastQuery = slot.queries[span * 2 + 1];
+    ext->glQueryCounter(slot.lastQuery, GL_TIMESTAMP);
+    slot.spans[span].ended = true;
+}
+
+void GpuTimer::snapshot(FrameTimings &timings) const
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_resultMutex);
+    if (_hasResult)
+        timings._setGpuRecord(_result);
+}
+
+double GpuTimer::getFrameDuration() const
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_resultMutex);
+    return _hasResult ? _result.frameDuration : 0.0;
+}
+
+void GpuTimer::releaseGLObjects(osg::State *state)
+{
+    const osg::GLExtensions *ext = nullptr;
+    if (state)
+        ext = state->get<osg::GLExtensions>();
+    for (auto &slot: _slots)
+    {
+        if (ext && !slot.queries.empty())
+            ext->glDeleteQueries(slot.queries.size(), slot.queries.data());
+        slot.queries.clear();
+        slot.spans.clear();
+        slot.pending = false;
+        slot.lastQuery = 0;
+    }
+    _measuring = false;
+    _firstFrame = true;
+}
+
+void GpuTimer::nextFrame(osg::State &state, unsigned int frameNumber)
+{
+    // Collect any completed frames, oldest first
+    for (unsigned int i = 1; i <= maxFrames; ++i)
+    {
+        Slot &slot = _slots[(_current + i) % maxFrames];
+        if (slot.pending && !collect(state, slot))
+            break;
+    }
+
+    // Only measure this frame if the next slot's queries are free
+    _current = (_current + 1) % maxFrames;
+    Slot &slot = _slots[_current];
+    _measuring = !slot.pending;
+    if (_measuring)
+    {
+        slot.frameNumber = frameNumber;
+        slot.spans.clear();
+    }
+}
+
+bool GpuTimer::collect(osg::State &state, Slot &slot)
+{
+    const auto *ext = state.get<osg::GLExtensions>();
+
+    // Timestamps complete in order, so check the last one issued
+    GLint available = 0;
+    ext->glGetQueryObjectiv(slot.lastQuery, GL_QUERY_RESULT_AVAILABLE,
+                            &available);
+    if (!available)
+        return false;
+
+    // Find how many views are referenced
+    uint32_t allViews = 0;
+    for (auto &span: slot.spans)
+        allViews |= span.viewMask;
+    unsigned int numViews = 0;
+    while (allViews >> numViews)
+        ++numViews;
+
+    _scratch.frameNumber = slot.frameNumber;
+    _scratch.viewDurations.assign(numViews, 0.0);
+    _scratch.swapchainDurations.assign(numViews, 0.0);
+    _scratch.sceneDuration = 0.0;
+    _scratch.shadingDuration = 0.0;
+    GLuint64 frameStart = 0, frameEnd = 0;
+
+    for (unsigned int i = 0; i < slot.spans.size(); ++i)
+    {
+        const Span &span = slot.spans[i];
+        if (!span.ended)
+            continue;
+
+        GLuint64 start = 0, end = 0;
+        ext->glGetQueryObjectui64v(slot.queries[i * 2], GL_QUERY_RESULT,
+                                   &start);
+        ext->glGetQueryObjectui64v(slot.queries[i * 2 + 1], GL_QUERY_RESULT,
+                                   &end);
+        double duration = (end - start) * 1e-9;
+        if (!frameStart || start < frameStart)
+            frameStart = start;
+        if (end > frameEnd)
+            frameEnd = end;
+
+        auto &durations = (span.target == TARGET_CAMERA)
+                            ? _scratch.viewDurations
+                            : _scratch.swapchainDurations;
+        for (unsigned int view = 0; view < numViews; ++view)
+            if (span.viewMask & (1u << view))
+                durations[view] += duration;
+
+        if (span.target == TARGET_CAMERA)
+        {
+            if (span.flags & View::CAM_MVR_SCENE_BIT)
+                _scratch.sceneDuration += duration;
+            if (span.flags & View::CAM_MVR_SHADING_BIT)
+                _scratch.shadingDuration += duration;
+        }
+    }
+    _scratch.frameDuration = (frameEnd - frameStart) * 1e-9;
+    slot.pending = false;
+
+    // Publish, keeping the old buffers for reuse
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_resultMutex);
+    std::swap(_result, _scratch);
+    _hasResult = true;
+    return true;
+}
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_GPU_TIMER
+#define OSGXR_GPU_TIMER 1
+
+#include <osgXR/FrameTimings>
+#include <osgXR/View>
+
+#include <osg/GL>
+#include <osg/Referenced>
+#include <osg/State>
+
+#include <OpenThreads/Mutex>
+
+#include <cstdint>
+#include <vector>
+
+namespace osgXR {
+
+/**
+ * Measures GPU time of draw passes with GL timestamp queries.
+ * Each span is bracketed by a pair of GL_TIMESTAMP queries, so spans may
+ * nest. Results are read back asynchronously a few frames later, and if they
+ * still aren't available by the time their queries are needed again, the
+ * current frame simply isn't measured, so the draw thread never stalls.
+ * All methods but snapshot() must be called from the draw thread with the GL
+ * context current.
+ */
+class GpuTimer : public osg::Referenced
+{
+    public:
+
+        /// What a span measures.
+        typedef enum Target
+        {
+            /// A camera draw, from initial to final draw callback.
+            TARGET_CAMERA,
+            /// A draw pass into a swapchain image.
+            TARGET_SWAPCHAIN,
+        } Target;
+
+        /// Number of frames of queries which may be in flight.
+        static constexpr unsigned int maxFrames = 4;
+
+        GpuTimer();
+
+        /**
+         * Begin a span.
+         * @param state       GL state of the current context.
+         * @param target      What the span measures.
+         * @param viewMask    Mask of the OpenXR view indices it relates to.
+         * @param flags       Flags of the camera being drawn.
+         * @return Span handle to pass to endSpan(), or -1 if not measured.
+         */
+        int beginSpan(osg::State &state, Target target, uint32_t viewMask,
+                      View::Flags flags = View::CAM_NO_BITS);
+        /// End a span started with beginSpan().
+        void endSpan(osg::State &state, int span);
+
+        /// Copy the most recently completed frame's results.
+        void snapshot(FrameTimings &timings) const;
+
+        /// Get the GPU frame duration of the most recently completed frame.
+        double getFrameDuration() const;
+
+        /// Delete GL query objects. GL context must be current.
+        void releaseGLObjects(osg::State *state);
+
+    protected:
+
+        virtual ~GpuTimer();
+
+        struct Span
+        {
+            Target target;
+            uint32_t viewMask;
+            View::Flags flags;
+            bool ended;
+        };
+
+        struct Slot
+        {
+            unsigned int frameNumber;
+            bool pending;
+            std::vector<Span> spans;
+            // Pair of timestamp queries per span, grown on demand
+            std::vector<GLuint> queries;
+            GLuint lastQuery;
+        };
+
+        /// Move on to a new frame.
+        void nextFrame(osg::State &state, unsigned int frameNumber);
+        /// Read back a slot's results if available.
+        bool collect(osg::State &state, Slot &slot);
+
+        Slot _slots[maxFrames];
+        unsigned int _current;
+        bool _measuring;
+        unsigned int _frameNumber;
+        bool _firstFrame;
+        bool _supported;
+        bool _checkedSupport;
+
+        // Most recently completed results
+        mutable OpenThreads::Mutex _resultMutex;
+        bool _hasResult;
+        FrameTimings::GpuRecord _result;
+        // Results being collected (draw thread only)
+        FrameTimings::GpuRecord _scratch;
+};
+
+} // osgXR
+
+#endif
@@ -92,8 +92,12 @@ void Manager::destroyAndWait()
 {
     _destroying = true;
     setEnabled(false);
+    // Frames may no longer be rendered, so don't wait on the graphics thread
+    bool threading = _state->stopViewerThreading();
     while (_state->isStateUpdateNeeded())
         _state->update();
+    if (threading)
+        _state->startViewerThreading();
 }
 
 bool Manager::isDestroying() const
@@ -116,6 +120,11 @@ void Manager::syncActionSetup()
     _state->syncActionSetup();
 }
 
+void Manager::getActionEvents(std::vector<ActionEvent> &events)
+{
+    _state->getActionEvents(events);
+}
+
 bool Manager::hasValidationLayer() const
 {
     return _state->hasValidationLayer();
@@ -182,6 +191,13 @@ const char *Manager::getStateString() const
     return _state->getStateString();
 }
 
+FrameTimings Manager::getFrameTimings() const
+{
+    FrameTimings timings;
+    _state->getFrameTimings(timings);
+    return timings;
+}
+
 void Manager::onRunning()
 {
 }
@@ -7,6 +7,7 @@
 #include "XRState.h"
 
 #include <osg/PolygonMode>
+#include <osgUtil/CullVisitor>
 
 using namespace osgXR;
 
@@ -114,6 +115,8 @@ class MirrorPreDrawCallback : public osg::Camera::DrawCallback
         void operator()(osg::RenderInfo& renderInfo) const override
         {
             const osg::FrameStamp *stamp = renderInfo.getState()->getFrameStamp();
+            // Submit the frame first so the mirror doesn't delay it
+            _xrState->endFrameBeforeMirror(stamp);
             _stateSet->setTextureAttributeAndModes(0,
                                 _xrState->getViewTexture(_viewIndex, stamp));
         }
@@ -125,6 +128,37 @@ class MirrorPreDrawCallback : public osg::Camera::DrawCallback
         unsigned int _viewIndex;
 };
 
+// Skips the mirror on frames the desktop window won't present
+class MirrorCullCallback : public osg::NodeCallback
+{
+    public:
+
+        explicit MirrorCullCallback(osg::ref_ptr<XRState> xrState) :
+            _xrState(xrState)
+        {
+        }
+
+        void operator()(osg::Node *node, osg::NodeVisitor *nv) override
+        {
+            osg::ref_ptr<XRState> xrState;
+            auto *cv = dynamic_cast<osgUtil::CullVisitor *>(nv);
+            if (cv && _xrState.lock(xrState) &&
+                !xrState->shouldPresent(cv->getFrameStamp()))
+            {
+                // Don't clear either, if it has its own render stage
+                osgUtil::RenderStage *stage = cv->getCurrentRenderStage();
+                if (stage->getCamera() == node)
+                    stage->setClearMask(0);
+                return;
+            }
+            traverse(node, nv);
+        }
+
+    protected:
+
+        osg::observer_ptr<XRState> _xrState;
+};
+
 class MirrorPostDrawCallback : public osg::Camera::DrawCallback
 {
     public:
@@ -196,4 +230,14 @@ void Mirror::setupQuad(unsigned int viewIndex,
     _camera->addPreDrawCallback(new MirrorPreDrawCallback(_manager->_getXrState(),
                                                           state, viewIndex));
     _camera->addPostDrawCallback(new MirrorPostDrawCallback(state));
+
+    // Only draw the mirror when the desktop window will present it. This
+    // must come first so it can skip any other cull callbacks too.
+    for (const osg::Callback *callback = _camera->getCullCallback();
+         callback; callback = callback->getNestedCallback())
+        if (dynamic_cast<const MirrorCullCallback *>(callback))
+            return;
+    osg::ref_ptr<osg::Callback> callback = new MirrorCullCallback(xrState);
+    callback->setNestedCallback(_camera->getCullCallback());
+    _camera->setCullCallback(callback);
 }
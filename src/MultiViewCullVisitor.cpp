@@ -0,0 +1,402 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "MultiViewCullVisitor.h"
+
+#include <osg/BufferObject>
+#include <osg/Camera>
+#include <osg/Drawable>
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/LOD>
+#include <osg/Polytope>
+#include <osg/PrimitiveSet>
+#include <osg/State>
+#include <osg/Switch>
+#include <osg/Transform>
+#include <osg/Uniform>
+#include <osg/VertexArrayState>
+
+#include <osgUtil/RenderLeaf>
+#include <osgUtil/SceneView>
+
+#include <osgViewer/Renderer>
+
+#include <OpenThreads/ScopedLock>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace osgXR;
+
+// Views beyond this don't get view mask state sets
+static const unsigned int maxMaskedViews = 8;
+
+MultiViewCullVisitor::Frustums::Frustums(unsigned int numViews) :
+    _numViews(numViews),
+    // Until set, accept everything
+    _planes(numViews * 4, osg::Vec4f(0.0f, 0.0f, 0.0f, 1.0f))
+{
+}
+
+void MultiViewCullVisitor::Frustums::setView(unsigned int view,
+                                             const osg::Matrix &viewToClip)
+{
+    // Just the sides, the shared frustum handles near and far
+    osg::Polytope frustum;
+    frustum.setToUnitFrustum(false, false);
+    frustum.transformProvidingInverse(viewToClip);
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+    unsigned int i = view * 4;
+    for (auto &plane: frustum.getPlaneList())
+    {
+        osg::Plane unitPlane(plane);
+        unitPlane.makeUnitLength();
+        _planes[i++] = unitPlane.asVec4();
+    }
+}
+
+void MultiViewCullVisitor::Frustums::getPlanes(std::vector<osg::Vec4f> &planes) const
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+    planes = _planes;
+}
+
+// Draw a primitive set with an instance for each view
+static void drawInstanced(osg::State &state,
+                          const osg::PrimitiveSet &primitiveSet,
+                          bool useVBOs, unsigned int numViews)
+{
+    GLsizei numInstances = std::max(primitiveSet.getNumInstances(), 1) * numViews;
+    GLenum mode = primitiveSet.getMode();
+    switch (primitiveSet.getType())
+    {
+    case osg::PrimitiveSet::DrawArraysPrimitiveType:
+        {
+            auto &drawArrays = static_cast<const osg::DrawArrays &>(primitiveSet);
+            state.glDrawArraysInstanced(mode, drawArrays.getFirst(),
+                                        drawArrays.getCount(), numInstances);
+            break;
+        }
+    case osg::PrimitiveSet::DrawArrayLengthsPrimitiveType:
+        {
+            auto &drawLengths = static_cast<const osg::DrawArrayLengths &>(primitiveSet);
+            GLint first = drawLengths.getFirst();
+            for (GLsizei count: drawLengths)
+            {
+                state.glDrawArraysInstanced(mode, first, count, numInstances);
+                first += count;
+            }
+            break;
+        }
+    case osg::PrimitiveSet::DrawElementsUBytePrimitiveType:
+    case osg::PrimitiveSet::DrawElementsUShortPrimitiveType:
+    case osg::PrimitiveSet::DrawElementsUIntPrimitiveType:
+        {
+            const osg::DrawElements *drawElements = primitiveSet.getDrawElements();
+            unsigned int numIndices = drawElements->getNumIndices();
+            if (!numIndices)
+                break;
+            GLenum type = GL_UNSIGNED_INT;
+            if (primitiveSet.getType() == osg::PrimitiveSet::DrawElementsUBytePrimitiveType)
+                type = GL_UNSIGNED_BYTE;
+            else if (primitiveSet.getType() == osg::PrimitiveSet::DrawElementsUShortPrimitiveType)
+                type = GL_UNSIGNED_SHORT;
+
+            // Index from the element buffer like DrawElements::draw()
+            const GLvoid *indices = drawElements->getDataPointer();
+            if (useVBOs)
+            {
+                osg::VertexArrayState *vas = state.getCurrentVertexArrayState();
+                osg::GLBufferObject *ebo = drawElements->getOrCreateGLBufferObject(state.getContextID());
+                if (ebo)
+                {
+                    vas->bindElementBufferObject(ebo);
+                    indices = (const GLvoid *)(ebo->getOffset(drawElements->getBufferIndex()));
+                }
+                else
+                {
+                    vas->unbindElementBufferObject();
+                }
+            }
+            state.glDrawElementsInstanced(mode, numIndices, type, indices,
+                                          numInstances);
+            break;
+        }
+    default:
+        // Others are only drawn to the first view
+        primitiveSet.draw(state, useVBOs);
+        break;
+    }
+}
+
+MultiViewCullVisitor::InstancedGeometry::InstancedGeometry() :
+    _geometry(nullptr),
+    _numViews(1)
+{
+    setSupportsDisplayList(false);
+}
+
+MultiViewCullVisitor::InstancedGeometry::InstancedGeometry(const InstancedGeometry &other,
+                                                           const osg::CopyOp &copyop) :
+    osg::Drawable(other, copyop),
+    _geometry(other._geometry),
+    _numViews(other._numViews)
+{
+}
+
+void MultiViewCullVisitor::InstancedGeometry::drawImplementation(osg::RenderInfo &renderInfo) const
+{
+    osg::State &state = *renderInfo.getState();
+
+    // Set up the geometry's arrays as it would, but on the current vertex
+    // array state rather than its own VAOs
+    bool useVBOs = state.useVertexBufferObject(_geometry->getSupportsVertexBufferObjects() &&
+                                               _geometry->getUseVertexBufferObjects());
+    osg::VertexArrayState *vas = state.getCurrentVertexArrayState();
+    vas->setVertexBufferObjectSupported(useVBOs);
+    _geometry->drawVertexArraysImplementation(renderInfo);
+
+    for (const auto &primitiveSet: _geometry->getPrimitiveSetList())
+        if (primitiveSet.valid())
+            drawInstanced(state, *primitiveSet, useVBOs, _numViews);
+
+    if (useVBOs)
+    {
+        vas->unbindVertexBufferObject();
+        vas->unbindElementBufferObject();
+    }
+}
+
+bool MultiViewCullVisitor::install(osg::Camera *camera, unsigned int numViews,
+                                   Frustums *frustums, bool instanceViews)
+{
+    auto *renderer = dynamic_cast<osgViewer::Renderer *>(camera->getRenderer());
+    if (!renderer)
+        return false;
+
+    // The renderer double buffers its scene views
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        osgUtil::SceneView *sceneView = renderer->getSceneView(i);
+        if (sceneView && sceneView->getCullVisitor())
+            sceneView->setCullVisitor(new MultiViewCullVisitor(*sceneView->getCullVisitor(),
+                                                               numViews,
+                                                               frustums,
+                                                               instanceViews));
+    }
+
+    // Drawables visible to all views
+    if (frustums)
+        camera->getOrCreateStateSet()->addUniform(new osg::Uniform("osgxr_view_mask",
+                                                                   (int)((1u << numViews) - 1)));
+    return true;
+}
+
+MultiViewCullVisitor::MultiViewCullVisitor(const osgUtil::CullVisitor &cv,
+                                           unsigned int numViews,
+                                           Frustums *frustums,
+                                           bool instanceViews) :
+    osgUtil::CullVisitor(cv),
+    _frustums(frustums),
+    _instanceViews(instanceViews),
+    _numViews(numViews),
+    _allViews((1u << numViews) - 1),
+    _nestedCameras(0),
+    _absoluteTransforms(0),
+    _numInstancedGeometries(0)
+{
+    if (_frustums.valid() && _numViews <= maxMaskedViews)
+    {
+        // Masks with all views or none never need a state set
+        _viewMaskStateSets.resize(_allViews);
+        for (uint32_t mask = 1; mask < _allViews; ++mask)
+        {
+            osg::StateSet *stateSet = new osg::StateSet;
+            stateSet->addUniform(new osg::Uniform("osgxr_view_mask",
+                                                  (int)mask));
+            _viewMaskStateSets[mask] = stateSet;
+        }
+    }
+}
+
+void MultiViewCullVisitor::reset()
+{
+    osgUtil::CullVisitor::reset();
+    _nestedCameras = 0;
+    _absoluteTransforms = 0;
+    _numInstancedGeometries = 0;
+
+    // Take a consistent copy of the frustums for this traversal
+    if (_frustums.valid())
+        _frustums->getPlanes(_planes);
+    else
+        _planes.clear();
+    unsigned int numPlanes = _planes.size();
+    _planeX.resize(numPlanes);
+    _planeY.resize(numPlanes);
+    _planeZ.resize(numPlanes);
+    _planeW.resize(numPlanes);
+    _distances.resize(numPlanes);
+    for (unsigned int i = 0; i < numPlanes; ++i)
+    {
+        _planeX[i] = _planes[i].x();
+        _planeY[i] = _planes[i].y();
+        _planeZ[i] = _planes[i].z();
+        _planeW[i] = _planes[i].w();
+    }
+}
+
+uint32_t MultiViewCullVisitor::getViewMask(const osg::BoundingSphere &bs) const
+{
+    // The planes are only meaningful in the shared view space of the
+    // installed camera's own render stage
+    if (!_frustums.valid() || _nestedCameras || _absoluteTransforms ||
+        !bs.valid())
+        return _allViews;
+
+    // Transform into shared view space
+    const osg::RefMatrix *modelView = getModelViewMatrix();
+    if (!modelView)
+        return _allViews;
+    const osg::Matrix &mv = *modelView;
+    osg::Vec3f center = bs.center() * mv;
+    // Be conservative with non-uniform scales
+    double scale2 = std::max(osg::Vec3d(mv(0, 0), mv(0, 1), mv(0, 2)).length2(),
+                             std::max(osg::Vec3d(mv(1, 0), mv(1, 1), mv(1, 2)).length2(),
+                                      osg::Vec3d(mv(2, 0), mv(2, 1), mv(2, 2)).length2()));
+    float radius = bs.radius() * std::sqrt(scale2);
+
+    // Signed distances from every plane of every view in one pass
+    unsigned int numPlanes = _distances.size();
+    const float *px = _planeX.data();
+    const float *py = _planeY.data();
+    const float *pz = _planeZ.data();
+    const float *pw = _planeW.data();
+    float *dist = _distances.data();
+    for (unsigned int i = 0; i < numPlanes; ++i)
+        dist[i] = px[i] * center.x() + py[i] * center.y() +
+                  pz[i] * center.z() + pw[i];
+
+    uint32_t mask = 0;
+    for (unsigned int view = 0; view < _numViews; ++view)
+    {
+        const float *viewDist = &dist[view * 4];
+        if (viewDist[0] >= -radius && viewDist[1] >= -radius &&
+            viewDist[2] >= -radius && viewDist[3] >= -radius)
+            mask |= (1u << view);
+    }
+    return mask;
+}
+
+void MultiViewCullVisitor::apply(osg::Node &node)
+{
+    if (node.isCullingActive() && !getViewMask(node.getBound()))
+        return;
+    osgUtil::CullVisitor::apply(node);
+}
+
+void MultiViewCullVisitor::apply(osg::Group &node)
+{
+    if (node.isCullingActive() && !getViewMask(node.getBound()))
+        return;
+    osgUtil::CullVisitor::apply(node);
+}
+
+void MultiViewCullVisitor::apply(osg::Transform &node)
+{
+    // The bound is in the parent's coordinate frame
+    if (node.isCullingActive() && !getViewMask(node.getBound()))
+        return;
+
+    // Children of absolute transforms aren't in shared view space
+    if (node.getReferenceFrame() != osg::Transform::RELATIVE_RF)
+    {
+        ++_absoluteTransforms;
+        osgUtil::CullVisitor::apply(node);
+        --_absoluteTransforms;
+        return;
+    }
+    osgUtil::CullVisitor::apply(node);
+}
+
+void MultiViewCullVisitor::apply(osg::Camera &camera)
+{
+    // Nested cameras (render to texture, shadows etc) have their own views,
+    // or render stages which aren't drawn per view
+    ++_nestedCameras;
+    osgUtil::CullVisitor::apply(camera);
+    --_nestedCameras;
+}
+
+void MultiViewCullVisitor::apply(osg::Geode &node)
+{
+    if (node.isCullingActive() && !getViewMask(node.getBound()))
+        return;
+    osgUtil::CullVisitor::apply(node);
+}
+
+void MultiViewCullVisitor::apply(osg::Drawable &drawable)
+{
+    uint32_t mask = _allViews;
+    if (drawable.isCullingActive())
+    {
+        mask = getViewMask(drawable.getBound());
+        if (!mask)
+            return;
+    }
+
+    // Draw an instance for each view, but only in the multiview render stage
+    bool instance = _instanceViews && !_nestedCameras;
+    unsigned int numLeaves = _currentReuseRenderLeafIndex;
+
+    if (mask == _allViews || mask >= _viewMaskStateSets.size())
+    {
+        osgUtil::CullVisitor::apply(drawable);
+        if (instance && _currentReuseRenderLeafIndex != numLeaves)
+            instanceLastLeaf(drawable);
+        return;
+    }
+
+    // Only some views can see it
+    pushStateSet(_viewMaskStateSets[mask].get());
+    osgUtil::CullVisitor::apply(drawable);
+    if (instance && _currentReuseRenderLeafIndex != numLeaves)
+        instanceLastLeaf(drawable);
+    popStateSet();
+}
+
+void MultiViewCullVisitor::instanceLastLeaf(const osg::Drawable &drawable)
+{
+    osgUtil::RenderLeaf *leaf = _reuseRenderLeafList[_currentReuseRenderLeafIndex - 1].get();
+    if (leaf->_drawable != &drawable)
+        return;
+
+    // Geometry needing conversion or drawn by the app is left to the first
+    // view
+    const osg::Geometry *geometry = drawable.asGeometry();
+    if (!geometry || geometry->containsDeprecatedData() ||
+        geometry->getDrawCallback())
+        return;
+
+    if (_numInstancedGeometries == _instancedGeometries.size())
+        _instancedGeometries.push_back(new InstancedGeometry);
+    InstancedGeometry *instanced = _instancedGeometries[_numInstancedGeometries++].get();
+    instanced->set(geometry, _numViews);
+    leaf->_drawable = instanced;
+}
+
+void MultiViewCullVisitor::apply(osg::LOD &node)
+{
+    if (node.isCullingActive() && !getViewMask(node.getBound()))
+        return;
+    osgUtil::CullVisitor::apply(node);
+}
+
+void MultiViewCullVisitor::apply(osg::Switch &node)
+{
+    if (node.isCullingActive() && !getViewMask(node.getBound()))
+        return;
+    osgUtil::CullVisitor::apply(node);
+}
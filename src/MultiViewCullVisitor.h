@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_MULTIVIEW_CULL_VISITOR
+#define OSGXR_MULTIVIEW_CULL_VISITOR 1
+
+#include <osg/Drawable>
+#include <osg/Matrix>
+#include <osg/Referenced>
+#include <osg/StateSet>
+#include <osg/ref_ptr>
+
+#include <osgUtil/CullVisitor>
+
+#include <OpenThreads/Mutex>
+
+#include <cstdint>
+#include <vector>
+
+namespace osg {
+    class Camera;
+    class Geometry;
+};
+
+namespace osgXR {
+
+/**
+ * Cull visitor for single pass multiview cameras.
+ * The camera's own frustum is a shared frustum bounding all the views, so
+ * objects between or beside the views may pass it. This additionally tests
+ * each node against the frustum of every view in the same traversal, skipping
+ * nodes which no view can see, and tags drawables which only some views can
+ * see with an "osgxr_view_mask" uniform so shaders can skip the other views.
+ * Nodes under nested cameras or absolute reference frame transforms aren't in
+ * the shared view space, so they are only culled against their own frustum.
+ *
+ * For instanced multiview it can also draw the geometry it accepts with its
+ * instance counts multiplied by the number of views, so each draw covers all
+ * views. This is done at draw time without modifying the scene graph.
+ */
+class MultiViewCullVisitor : public osgUtil::CullVisitor
+{
+    public:
+
+        /// Per-view frustums shared between cull visitors of a camera.
+        class Frustums : public osg::Referenced
+        {
+            public:
+
+                explicit Frustums(unsigned int numViews);
+
+                unsigned int getNumViews() const
+                {
+                    return _numViews;
+                }
+
+                /**
+                 * Set a view's frustum.
+                 * @param view       Index of view.
+                 * @param viewToClip Transform from shared view space to the
+                 *                   view's clip space.
+                 */
+                void setView(unsigned int view, const osg::Matrix &viewToClip);
+
+                /// Copy the side planes of all views, 4 per view.
+                void getPlanes(std::vector<osg::Vec4f> &planes) const;
+
+            protected:
+
+                unsigned int _numViews;
+                mutable OpenThreads::Mutex _mutex;
+                std::vector<osg::Vec4f> _planes;
+        };
+
+        /**
+         * Install multiview cull visitors on a camera's renderer.
+         * @param frustums  Optional per-view frustums to cull against, which
+         *                  the caller updates each frame.
+         * @param instanceViews Whether to draw an instance of geometry for
+         *                      each view.
+         * @return false if the camera has no renderer.
+         */
+        static bool install(osg::Camera *camera, unsigned int numViews,
+                            Frustums *frustums, bool instanceViews = false);
+
+        MultiViewCullVisitor(const osgUtil::CullVisitor &cv,
+                             unsigned int numViews,
+                             Frustums *frustums,
+                             bool instanceViews);
+
+        osgUtil::CullVisitor *clone() const override
+        {
+            return new MultiViewCullVisitor(*this, _numViews,
+                                            _frustums.get(),
+                                            _instanceViews);
+        }
+
+        void reset() override;
+
+        void apply(osg::Node &node) override;
+        void apply(osg::Group &node) override;
+        void apply(osg::Transform &node) override;
+        void apply(osg::Camera &camera) override;
+        void apply(osg::Geode &node) override;
+        void apply(osg::Drawable &drawable) override;
+        void apply(osg::LOD &node) override;
+        void apply(osg::Switch &node) override;
+
+    protected:
+
+        /**
+         * Draws the primitive sets of a geometry with their instance counts
+         * multiplied by the number of views, in place of the geometry in a
+         * render leaf, so the scene graph itself is left untouched.
+         */
+        class InstancedGeometry : public osg::Drawable
+        {
+            public:
+
+                InstancedGeometry();
+                InstancedGeometry(const InstancedGeometry &other,
+                                  const osg::CopyOp &copyop = osg::CopyOp::SHALLOW_COPY);
+
+                META_Object(osgXR, InstancedGeometry);
+
+                void set(const osg::Geometry *geometry, unsigned int numViews)
+                {
+                    _geometry = geometry;
+                    _numViews = numViews;
+                }
+
+                void drawImplementation(osg::RenderInfo &renderInfo) const override;
+
+            protected:
+
+                const osg::Geometry *_geometry;
+                unsigned int _numViews;
+        };
+
+        /// Draw the drawable of the last render leaf once for each view.
+        void instanceLastLeaf(const osg::Drawable &drawable);
+
+        /// Find which views can see a bounding sphere in model space.
+        uint32_t getViewMask(const osg::BoundingSphere &bs) const;
+
+        osg::ref_ptr<Frustums> _frustums;
+        bool _instanceViews;
+
+        // Planes for this traversal, as separate arrays of components so the
+        // tests of all views vectorise
+        unsigned int _numViews;
+        uint32_t _allViews;
+        std::vector<osg::Vec4f> _planes;
+        std::vector<float> _planeX, _planeY, _planeZ, _planeW;
+        mutable std::vector<float> _distances;
+
+        // Depth of nested cameras and absolute transforms being traversed,
+        // under which per-view tests don't apply
+        unsigned int _nestedCameras;
+        unsigned int _absoluteTransforms;
+
+        // State sets with osgxr_view_mask uniforms, indexed by view mask
+        std::vector<osg::ref_ptr<osg::StateSet>> _viewMaskStateSets;
+
+        // Instanced geometry reused each traversal like render leaves, as
+        // the render graph referencing them is drawn before the next one
+        std::vector<osg::ref_ptr<InstancedGeometry>> _instancedGeometries;
+        unsigned int _numInstancedGeometries;
+};
+
+} // osgXR
+
+#endif
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_OBJECT_POOL
+#define OSGXR_OBJECT_POOL 1
+
+#include <osg/ref_ptr>
+
+#include <vector>
+
+namespace osgXR {
+
+/**
+ * Pool of reference counted objects for reuse across frames.
+ * The pool keeps a reference to each object, and an object is considered
+ * unused once the pool's is the only remaining reference. This allows per-frame
+ * objects to be recycled without having to track when each holder is done with
+ * them, so that once the pool has grown to the number of objects in flight the
+ * frame loop needn't allocate any more.
+ *
+ * The pool itself isn't thread safe, but references to its objects may be
+ * dropped from any thread.
+ */
+template <typename T>
+class ObjectPool
+{
+    public:
+
+        /**
+         * Get an object which is no longer referenced outside the pool.
+         * @return An unused object, or nullptr if there are none, in which
+         *         case a new object should be created and added with add().
+         */
+        T *getUnused() const
+        {
+            for (auto &object: _objects)
+                if (object->referenceCount() == 1)
+                    return object.get();
+            return nullptr;
+        }
+
+        /// Add a new object to the pool.
+        void add(T *object)
+        {
+            _objects.push_back(object);
+        }
+
+        /// Drop all the pool's references.
+        void clear()
+        {
+            _objects.clear();
+        }
+
+    protected:
+
+        std::vector<osg::ref_ptr<T>> _objects;
+};
+
+} // osgXR
+
+#endif
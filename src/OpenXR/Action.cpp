@@ -61,12 +61,17 @@ ActionStateBase::ActionStateBase(Action *action, Session *session,
     _session(session),
     _subactionPath(subactionPath),
     _valid(false),
-    _syncCount(0)
+    _syncCount(0),
+    _read(false),
+    _snapshotSlot(0),
+    _snapshotSyncCount(0)
 {
+    _session->registerActionState(this);
 }
 
 ActionStateBase::~ActionStateBase()
 {
+    _session->unregisterActionState(this);
 }
 
 bool ActionStateBase::checkUpdate()
@@ -76,9 +81,24 @@ bool ActionStateBase::checkUpdate()
     bool needsUpdate = (_syncCount < sessionSyncCount);
     // Update the counter as caller is expected to update the state
     _syncCount = sessionSyncCount;
+    _read = true;
     return needsUpdate;
 }
 
+const ActionStateSnapshot *ActionStateBase::getSnapshot()
+{
+    const ActionStateSnapshot *snapshot = _session->getLatestActionStateSnapshot();
+    unsigned int sessionSyncCount = _session->getActionSyncCount();
+    // A snapshot from before the latest sync, or from before this state was
+    // created in a reused slot, doesn't hold this state
+    if (!snapshot || snapshot->getSyncCount() != sessionSyncCount ||
+        _snapshotSyncCount != sessionSyncCount ||
+        !snapshot->isValid(_snapshotSlot))
+        return nullptr;
+    _read = true;
+    return snapshot;
+}
+
 template <>
 bool ActionStateCommonBoolean::updateState()
 {
@@ -5,6 +5,7 @@
 #define OSGXR_OPENXR_ACTION 1
 
 #include "ActionSet.h"
+#include "ActionStateSnapshot.h"
 #include "Path.h"
 
 #include <osg/Vec2f>
@@ -109,6 +110,35 @@ class ActionStateBase : public osg::Referenced
             return _action->check(result, actionMsg);
         }
 
+        // Snapshots
+
+        /// Get the slot of this state in the session's snapshots.
+        unsigned int getSnapshotSlot() const
+        {
+            return _snapshotSlot;
+        }
+        /// Set the slot of this state in the session's snapshots.
+        void setSnapshotSlot(unsigned int slot)
+        {
+            _snapshotSlot = slot;
+        }
+
+        /**
+         * Update state after a sync if it has been read since the last
+         * refresh, and write it to a snapshot.
+         * @return true if the state was written to the snapshot.
+         */
+        virtual bool refresh(ActionStateSnapshot &snapshot) = 0;
+
+        /**
+         * Get the session's latest snapshot if it holds this state.
+         * This must be called from the thread syncing actions, and counts as
+         * a read of the state so it is kept in the next snapshot.
+         * @return The snapshot if this state was written to it after the
+         *         latest sync, otherwise nullptr.
+         */
+        const ActionStateSnapshot *getSnapshot();
+
     protected:
 
         // Utilities for synchronisation
@@ -123,6 +153,11 @@ class ActionStateBase : public osg::Referenced
         Path _subactionPath;
         bool _valid;
         unsigned int _syncCount;
+        // Whether the state has been read since the last refresh
+        bool _read;
+        unsigned int _snapshotSlot;
+        // Sync count of the last snapshot this state was written to
+        unsigned int _snapshotSyncCount;
 };
 
 /// All action states have an isActive field.
@@ -161,6 +196,20 @@ class ActionStateCommon : public ActionStateBase
             return valid();
         }
 
+        bool refresh(ActionStateSnapshot &snapshot) override
+        {
+            // Skip states the app has stopped reading
+            if (!_read)
+                return false;
+            bool ret = update();
+            _read = false;
+            if (!ret)
+                return false;
+            snapshot.setActive(_snapshotSlot, _state.isActive);
+            _snapshotSyncCount = snapshot.getSyncCount();
+            return true;
+        }
+
     protected:
 
         // Protected operations
@@ -191,6 +240,16 @@ struct ActionTypeInfo<XrActionStateBoolean>
         return value;
     }
 
+    static osg::Vec2f toVec2f(XrBool32 value)
+    {
+        return osg::Vec2f(value ? 1.0f : 0.0f, 0.0f);
+    }
+
+    static bool fromVec2f(const osg::Vec2f &value)
+    {
+        return value.x() != 0.0f;
+    }
+
     static bool defaultValue()
     {
         return false;
@@ -206,6 +265,16 @@ struct ActionTypeInfo<XrActionStateFloat>
         return value;
     }
 
+    static osg::Vec2f toVec2f(float value)
+    {
+        return osg::Vec2f(value, 0.0f);
+    }
+
+    static float fromVec2f(const osg::Vec2f &value)
+    {
+        return value.x();
+    }
+
     static float defaultValue()
     {
         return 0.0f;
@@ -221,6 +290,16 @@ struct ActionTypeInfo<XrActionStateVector2f>
         return osg::Vec2f(value.x, value.y);
     }
 
+    static osg::Vec2f toVec2f(const XrVector2f &value)
+    {
+        return convert(value);
+    }
+
+    static osg::Vec2f fromVec2f(const osg::Vec2f &value)
+    {
+        return value;
+    }
+
     static osg::Vec2f defaultValue()
     {
         return osg::Vec2f(0.0f, 0.0f);
@@ -266,6 +345,17 @@ class ActionStateSimple : public ActionStateCommon<T>
             assert(this->valid());
             return Base::_state.lastChangedTime;
         }
+
+        bool refresh(ActionStateSnapshot &snapshot) override
+        {
+            if (!Base::refresh(snapshot))
+                return false;
+            snapshot.setValue(this->_snapshotSlot,
+                              Info::toVec2f(Base::_state.currentState),
+                              Base::_state.changedSinceLastSync,
+                              Base::_state.lastChangedTime);
+            return true;
+        }
 };
 
 // These are the simple action state classes
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_OPENXR_ACTION_STATE_SNAPSHOT
+#define OSGXR_OPENXR_ACTION_STATE_SNAPSHOT 1
+
+#include <osg/Referenced>
+#include <osg/Vec2f>
+
+#include <openxr/openxr.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace osgXR {
+
+namespace OpenXR {
+
+/**
+ * Snapshot of all input action states after an xrSyncActions.
+ * Each action state registered with the session has a fixed slot, and the
+ * fields of all slots are stored in separate contiguous arrays. Boolean and
+ * float values are stored in the X component of the value. Slots of states
+ * which weren't read since the previous snapshot are left invalid. Once
+ * published by the session a snapshot is immutable, so it can be read from
+ * other threads while they hold a reference to it.
+ */
+class ActionStateSnapshot : public osg::Referenced
+{
+    public:
+
+        ActionStateSnapshot() :
+            _syncCount(0)
+        {
+        }
+
+        /// Clear all slots ready to be filled for a sync.
+        void reset(unsigned int numSlots, unsigned int syncCount)
+        {
+            _syncCount = syncCount;
+            _valid.assign(numSlots, 0);
+            _active.assign(numSlots, 0);
+            _changed.assign(numSlots, 0);
+            _lastChangedTime.assign(numSlots, 0);
+            _value.assign(numSlots, osg::Vec2f(0.0f, 0.0f));
+        }
+
+        void setActive(unsigned int slot, bool active)
+        {
+            _valid[slot] = 1;
+            _active[slot] = active;
+        }
+
+        void setValue(unsigned int slot, const osg::Vec2f &value,
+                      bool changed, XrTime lastChangedTime)
+        {
+            _value[slot] = value;
+            _changed[slot] = changed;
+            _lastChangedTime[slot] = lastChangedTime;
+        }
+
+        // Accessors
+
+        /// Get the session's action sync count the snapshot was taken after.
+        unsigned int getSyncCount() const
+        {
+            return _syncCount;
+        }
+
+        unsigned int getNumSlots() const
+        {
+            return _valid.size();
+        }
+
+        /// Find whether the state in a slot was successfully read.
+        bool isValid(unsigned int slot) const
+        {
+            return slot < _valid.size() && _valid[slot];
+        }
+
+        bool isActive(unsigned int slot) const
+        {
+            return _active[slot];
+        }
+
+        bool hasChangedSinceLastSync(unsigned int slot) const
+        {
+            return _changed[slot];
+        }
+
+        XrTime getLastChangedTime(unsigned int slot) const
+        {
+            return _lastChangedTime[slot];
+        }
+
+        const osg::Vec2f &getValue(unsigned int slot) const
+        {
+            return _value[slot];
+        }
+
+    protected:
+
+        unsigned int _syncCount;
+        std::vector<uint8_t> _valid;
+        std::vector<uint8_t> _active;
+        std::vector<uint8_t> _changed;
+        std::vector<XrTime> _lastChangedTime;
+        std::vector<osg::Vec2f> _value;
+};
+
+} // osgXR::OpenXR
+
+} // osgXR
+
+#endif
@@ -20,8 +20,9 @@ void CompositionLayerProjection::addView(osg::ref_ptr<Session::Frame> frame, uin
 
     XrCompositionLayerProjectionView &projView = _projViews[viewIndex];
     projView = { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW };
-    projView.pose = frame->getViewPose(viewIndex);
-    projView.fov = frame->getViewFov(viewIndex);
+    // Submit the view locations that were actually rendered
+    projView.pose = frame->getSubmitViewPose(viewIndex);
+    projView.fov = frame->getSubmitViewFov(viewIndex);
     subImage.getXrSubImage(&projView.subImage);
 
     if (depthInfo && subImage.depthValid())
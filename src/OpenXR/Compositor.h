@@ -64,14 +64,21 @@ class CompositionLayerProjection : public CompositionLayer
         {
             _layer.type = XR_TYPE_COMPOSITION_LAYER_PROJECTION;
             _layer.next = nullptr;
-            _projViews.resize(viewCount);
-            _depthInfos.resize(viewCount);
+            reset(viewCount);
         }
 
         virtual ~CompositionLayerProjection()
         {
         }
 
+        /// Clear the views so the layer can be reused for a new frame.
+        void reset(unsigned int viewCount)
+        {
+            // Keeps the capacity, so reuse doesn't allocate
+            _projViews.assign(viewCount, XrCompositionLayerProjectionView());
+            _depthInfos.assign(viewCount, XrCompositionLayerDepthInfoKHR());
+        }
+
         void addView(osg::ref_ptr<Session::Frame> frame, uint32_t viewIndex,
                      const SwapchainGroup::SubImage &subImage,
                      const DepthInfo *depthInfo = nullptr);
@@ -7,11 +7,14 @@
 #include "Session.h"
 #include "System.h"
 #include "generated/Version.h"
+#include "../Trace.h"
 
 #include <osg/Notify>
 #include <osg/Version>
 #include <osg/ref_ptr>
 
+#include <OpenThreads/ScopedLock>
+
 #include <cstring>
 #include <vector>
 
@@ -250,6 +253,12 @@ Instance::InitResult Instance::init(const char *appName, uint32_t appVersion)
         }
     }
 
+#ifdef XR_KHR_locate_spaces
+    // Enable batched space location if available, it's core in OpenXR 1.1
+    if (hasExtension(XR_KHR_LOCATE_SPACES_EXTENSION_NAME))
+        enableExtension(XR_KHR_LOCATE_SPACES_EXTENSION_NAME);
+#endif
+
     // Get list of extensions
     for (auto &extension: _extensions)
         extensionNames.push_back(extension.c_str());
@@ -346,6 +355,12 @@ Instance::InitResult Instance::init(const char *appName, uint32_t appVersion)
     }
     if (isExtensionEnabled(XR_KHR_VISIBILITY_MASK_EXTENSION_NAME))
         _xrGetVisibilityMaskKHR = (PFN_xrGetVisibilityMaskKHR)getProcAddr("xrGetVisibilityMaskKHR");
+#ifdef XR_KHR_locate_spaces
+    if (_apiVersion >= XR_API_VERSION_1_1)
+        _xrLocateSpacesKHR = (PFN_xrLocateSpacesKHR)getProcAddr("xrLocateSpaces");
+    else if (isExtensionEnabled(XR_KHR_LOCATE_SPACES_EXTENSION_NAME))
+        _xrLocateSpacesKHR = (PFN_xrLocateSpacesKHR)getProcAddr("xrLocateSpacesKHR");
+#endif
 
     return INIT_SUCCESS;
 }
@@ -354,6 +369,11 @@ void Instance::deinit()
 {
     // Destroy the default debug messenger so it doesn't prevent destruction
     _defaultDebugMessenger = nullptr;
+
+    // Interned paths don't survive the instance
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_pathMutex);
+    _pathsByString.clear();
+    _stringsByPath.clear();
 }
 
 bool Instance::check(XrResult result, const char *actionMsg) const
@@ -389,6 +409,51 @@ PFN_xrVoidFunction Instance::getProcAddr(const char *name) const
     return ret;
 }
 
+XrPath Instance::stringToPath(const std::string &path) const
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_pathMutex);
+
+    auto it = _pathsByString.find(path);
+    if (it != _pathsByString.end())
+        return it->second;
+
+    XrPath xrPath = XR_NULL_PATH;
+    if (!check(xrStringToPath(_instance, path.c_str(), &xrPath),
+               "create OpenXR path from string"))
+        return XR_NULL_PATH;
+
+    _pathsByString.emplace(path, xrPath);
+    _stringsByPath.emplace(xrPath, path);
+    return xrPath;
+}
+
+const std::string &Instance::pathToString(XrPath path) const
+{
+    static const std::string emptyString;
+    if (path == XR_NULL_PATH)
+        return emptyString;
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_pathMutex);
+
+    auto it = _stringsByPath.find(path);
+    if (it != _stringsByPath.end())
+        return it->second;
+
+    uint32_t count;
+    if (!check(xrPathToString(_instance, path, 0, &count, nullptr),
+               "size OpenXR path string"))
+        return emptyString;
+    std::vector<char> buffer(count);
+    if (!check(xrPathToString(_instance, path,
+                              buffer.size(), &count, buffer.data()),
+               "get OpenXR path string"))
+        return emptyString;
+
+    auto &str = _stringsByPath.emplace(path, buffer.data()).first->second;
+    _pathsByString.emplace(str, path);
+    return str;
+}
+
 System *Instance::getSystem(XrFormFactor formFactor, bool *supported)
 {
     unsigned long ffId = formFactor - 1;
@@ -463,6 +528,7 @@ Session *Instance::getLoneSession()
 
 void Instance::pollEvents(EventHandler *handler)
 {
+    OSGXR_TRACE_SCOPE("Instance::pollEvents");
     for (;;)
     {
         XrEventDataBuffer event;
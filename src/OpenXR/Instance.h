@@ -8,12 +8,16 @@
 
 #include <map>
 #include <set>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <osg/Referenced>
 #include <osg/observer_ptr>
 #include <osg/ref_ptr>
 
+#include <OpenThreads/Mutex>
+
 #include <openxr/openxr.h>
 #define XR_USE_GRAPHICS_API_OPENGL
 #include <openxr/openxr_platform.h>
@@ -225,6 +229,46 @@ class Instance : public osg::Referenced
                                            visibilityMask);
         }
 
+        /// Find whether xrLocateSpaces() is supported.
+        bool hasLocateSpaces() const
+        {
+#ifdef XR_KHR_locate_spaces
+            return _xrLocateSpacesKHR != nullptr;
+#else
+            return false;
+#endif
+        }
+
+#ifdef XR_KHR_locate_spaces
+        XrResult xrLocateSpaces(XrSession session,
+                                const XrSpacesLocateInfoKHR *locateInfo,
+                                XrSpaceLocationsKHR *spaceLocations) const
+        {
+            if (!_xrLocateSpacesKHR)
+                return XR_ERROR_FUNCTION_UNSUPPORTED;
+            return _xrLocateSpacesKHR(session, locateInfo, spaceLocations);
+        }
+#endif
+
+        // Paths
+
+        /**
+         * Convert a path string to an XrPath.
+         * Results are interned so repeated conversions don't call into the
+         * runtime.
+         * @return The XrPath, or XR_NULL_PATH on failure.
+         */
+        XrPath stringToPath(const std::string &path) const;
+        /**
+         * Convert an XrPath to a path string.
+         * Results are interned so repeated conversions don't call into the
+         * runtime.
+         * @return A reference to the path string which remains valid until
+         *         the instance is deinitialised, or an empty string on
+         *         failure.
+         */
+        const std::string &pathToString(XrPath path) const;
+
         // Queries
 
         System *getSystem(XrFormFactor formFactor, bool *supported = nullptr);
@@ -267,6 +311,10 @@ class Instance : public osg::Referenced
         PFN_xrSessionEndDebugUtilsLabelRegionEXT _xrSessionEndDebugUtilsLabelRegionEXT = nullptr;
         PFN_xrSessionInsertDebugUtilsLabelEXT _xrSessionInsertDebugUtilsLabelEXT = nullptr;
         PFN_xrGetVisibilityMaskKHR _xrGetVisibilityMaskKHR = nullptr;
+#ifdef XR_KHR_locate_spaces
+        // Core in OpenXR 1.1, or from XR_KHR_locate_spaces
+        PFN_xrLocateSpacesKHR _xrLocateSpacesKHR = nullptr;
+#endif
 
         // Instance properties
         XrInstanceProperties _properties;
@@ -279,6 +327,11 @@ class Instance : public osg::Referenced
 
         // Sessions
         std::map<XrSession, Session *> _sessions;
+
+        // Interned paths
+        mutable OpenThreads::Mutex _pathMutex;
+        mutable std::unordered_map<std::string, XrPath> _pathsByString;
+        mutable std::unordered_map<XrPath, std::string> _stringsByPath;
 };
 
 } // osgXR::OpenXR
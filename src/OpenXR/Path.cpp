@@ -15,27 +15,15 @@ Path::Path(Instance *instance,
 Path::Path(Instance *instance,
            const std::string &path) :
     _instance(instance),
-    _path(XR_NULL_PATH)
+    _path(instance->stringToPath(path))
 {
-    check(xrStringToPath(getXrInstance(), path.c_str(), &_path),
-          "create OpenXR path from string");
 }
 
-std::string Path::toString() const
+const std::string &Path::toString() const
 {
+    static const std::string emptyString;
     if (!valid())
-        return "";
+        return emptyString;
 
-    uint32_t count;
-    if (!check(xrPathToString(getXrInstance(), _path,
-                              0, &count, nullptr),
-               "size OpenXR path string"))
-        return "";
-    std::vector<char> buffer(count);
-    if (!check(xrPathToString(getXrInstance(), _path,
-                              buffer.size(), &count, buffer.data()),
-               "get OpenXR path string"))
-        return "";
-
-    return buffer.data();
+    return _instance->pathToString(_path);
 }
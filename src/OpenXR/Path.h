@@ -50,7 +50,8 @@ class Path
             return _path;
         }
 
-        std::string toString() const;
+        /// Get the path string, which is interned by the instance.
+        const std::string &toString() const;
 
         // Comparisons
 
@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "ProbeCache.h"
+#include "../Trace.h"
+
+#include <osg/Notify>
+
+#include <fstream>
+#include <sstream>
+
+using namespace osgXR::OpenXR;
+
+/*
+ * The file is plain text, one record per line:
+ *   runtime <version> <name>
+ *   system <name>
+ *   viewconfig <type> <views> [<width> <height> <samples>]... <modes> [<mode>]...
+ *   formats <count> [<format>]...
+ */
+static const char *cacheHeader = "osgXR probe cache 1";
+
+ProbeCache::ProbeCache() :
+    _valid(false),
+    _runtimeVersion(0)
+{
+}
+
+bool ProbeCache::load(const std::string &filename, const System *system)
+{
+    OSGXR_TRACE_SCOPE("ProbeCache::load");
+    invalidate();
+
+    std::ifstream in(filename);
+    if (!in)
+        return false;
+
+    std::string line;
+    if (!std::getline(in, line) || line != cacheHeader)
+        return false;
+
+    bool ok = true;
+    while (ok && std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string record;
+        if (!(fields >> record))
+            continue;
+        if (record == "runtime")
+        {
+            fields >> _runtimeVersion >> std::ws;
+            if (!fields.eof())
+                std::getline(fields, _runtimeName);
+        }
+        else if (record == "system")
+        {
+            fields >> std::ws;
+            if (!fields.eof())
+                std::getline(fields, _systemName);
+        }
+        else if (record == "viewconfig")
+        {
+            ViewConfiguration viewConfig;
+            int type;
+            unsigned int count;
+            fields >> type >> count;
+            viewConfig.type = (XrViewConfigurationType)type;
+            for (unsigned int i = 0; fields && i < count; ++i)
+            {
+                uint32_t width, height, samples;
+                fields >> width >> height >> samples;
+                viewConfig.views.push_back(System::ViewConfiguration::View(width, height, samples));
+            }
+            fields >> count;
+            for (unsigned int i = 0; fields && i < count; ++i)
+            {
+                int mode;
+                fields >> mode;
+                viewConfig.envBlendModes.push_back((XrEnvironmentBlendMode)mode);
+            }
+            _viewConfigurations.push_back(viewConfig);
+        }
+        else if (record == "formats")
+        {
+            unsigned int count;
+            fields >> count;
+            for (unsigned int i = 0; fields && i < count; ++i)
+            {
+                int64_t format;
+                fields >> format;
+                _swapchainFormats.push_back(format);
+            }
+        }
+        // Tolerate unknown records
+        ok = !fields.fail();
+    }
+
+    if (!ok)
+    {
+        OSG_WARN << "osgXR: Ignoring malformed probe cache \"" << filename << "\"" << std::endl;
+        invalidate();
+        return false;
+    }
+
+    // Only use results from the same runtime and system
+    const Instance *instance = system->getInstance();
+    if (_runtimeName != instance->getRuntimeName() ||
+        _runtimeVersion != instance->getRuntimeVersion() ||
+        _systemName != system->getSystemName())
+    {
+        invalidate();
+        return false;
+    }
+
+    _valid = true;
+    return true;
+}
+
+bool ProbeCache::save(const std::string &filename) const
+{
+    OSGXR_TRACE_SCOPE("ProbeCache::save");
+    std::ofstream out(filename);
+    if (!out)
+    {
+        OSG_WARN << "osgXR: Failed to open probe cache \"" << filename << "\"" << std::endl;
+        return false;
+    }
+
+    out << cacheHeader << "\n";
+    out << "runtime " << _runtimeVersion << " " << _runtimeName << "\n";
+    out << "system " << _systemName << "\n";
+    for (auto &viewConfig: _viewConfigurations)
+    {
+        out << "viewconfig " << (int)viewConfig.type
+            << " " << viewConfig.views.size();
+        for (auto &view: viewConfig.views)
+            out << " " << view.getRecommendedWidth()
+                << " " << view.getRecommendedHeight()
+                << " " << view.getRecommendedSamples();
+        out << " " << viewConfig.envBlendModes.size();
+        for (auto mode: viewConfig.envBlendModes)
+            out << " " << (int)mode;
+        out << "\n";
+    }
+    out << "formats " << _swapchainFormats.size();
+    for (int64_t format: _swapchainFormats)
+        out << " " << format;
+    out << "\n";
+
+    if (!out)
+    {
+        OSG_WARN << "osgXR: Failed to write probe cache \"" << filename << "\"" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ProbeCache::invalidate()
+{
+    _valid = false;
+    _runtimeName.clear();
+    _runtimeVersion = 0;
+    _systemName.clear();
+    _viewConfigurations.clear();
+    _swapchainFormats.clear();
+}
+
+void ProbeCache::apply(System *system) const
+{
+    System::ViewConfigurations viewConfigs;
+    viewConfigs.reserve(_viewConfigurations.size());
+    for (auto &viewConfig: _viewConfigurations)
+        viewConfigs.push_back(System::ViewConfiguration(system, viewConfig.type,
+                                                        viewConfig.views,
+                                                        viewConfig.envBlendModes));
+    system->setViewConfigurations(viewConfigs);
+}
+
+void ProbeCache::record(const System *system)
+{
+    OSGXR_TRACE_SCOPE("ProbeCache::record");
+    invalidate();
+    setKey(system);
+
+    for (auto &viewConfig: system->getViewConfigurations())
+        _viewConfigurations.push_back({ viewConfig.getType(),
+                                        viewConfig.getViews(),
+                                        viewConfig.getEnvBlendModes() });
+    _valid = true;
+}
+
+void ProbeCache::setKey(const System *system)
+{
+    const Instance *instance = system->getInstance();
+    _runtimeName = instance->getRuntimeName();
+    _runtimeVersion = instance->getRuntimeVersion();
+    _systemName = system->getSystemName();
+}
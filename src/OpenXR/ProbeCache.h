@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_OPENXR_PROBE_CACHE
+#define OSGXR_OPENXR_PROBE_CACHE 1
+
+#include "System.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osgXR {
+
+namespace OpenXR {
+
+/**
+ * On-disk cache of runtime capabilities.
+ * This holds the results of enumerating a system's view configurations, views
+ * and environment blend modes, and a session's swapchain formats, so that
+ * later runs against the same runtime and system can skip enumerating them
+ * again. It is keyed by runtime name, runtime version and system name, so a
+ * runtime update automatically invalidates it.
+ */
+class ProbeCache
+{
+    public:
+
+        typedef std::vector<int64_t> SwapchainFormats;
+
+        ProbeCache();
+
+        /**
+         * Load the cache from a file.
+         * @param filename Path of the cache file.
+         * @param system   System whose runtime the cache must match.
+         * @return true if the file was loaded and matches @p system.
+         */
+        bool load(const std::string &filename, const System *system);
+        /// Save the cache to a file.
+        bool save(const std::string &filename) const;
+
+        /// Find whether the cache holds results for a system.
+        bool valid() const
+        {
+            return _valid;
+        }
+        /// Forget all cached results.
+        void invalidate();
+
+        /// Use cached view configurations for a system.
+        void apply(System *system) const;
+        /// Record a system's view configurations, enumerating as necessary.
+        void record(const System *system);
+
+        /// Find whether swapchain formats are cached.
+        bool hasSwapchainFormats() const
+        {
+            return _valid && !_swapchainFormats.empty();
+        }
+        /// Get cached swapchain formats, empty if unknown.
+        const SwapchainFormats &getSwapchainFormats() const
+        {
+            return _swapchainFormats;
+        }
+        /// Record a session's swapchain formats.
+        void setSwapchainFormats(const SwapchainFormats &formats)
+        {
+            _swapchainFormats = formats;
+        }
+
+    protected:
+
+        // Set the key from a system
+        void setKey(const System *system);
+
+        struct ViewConfiguration
+        {
+            XrViewConfigurationType type;
+            System::ViewConfiguration::Views views;
+            System::ViewConfiguration::EnvBlendModes envBlendModes;
+        };
+
+        bool _valid;
+
+        // Key
+        std::string _runtimeName;
+        XrVersion _runtimeVersion;
+        std::string _systemName;
+
+        // Cached results
+        std::vector<ViewConfiguration> _viewConfigurations;
+        SwapchainFormats _swapchainFormats;
+};
+
+} // osgXR::OpenXR
+
+} // osgXR
+
+#endif
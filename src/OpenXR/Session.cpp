@@ -9,12 +9,17 @@
 #define XR_USE_GRAPHICS_API_OPENGL
 #include <openxr/openxr_platform.h>
 
+#include "Action.h"
 #include "ActionSet.h"
 #include "Compositor.h"
 #include "Session.h"
 #include "GraphicsBinding.h"
+#include "../Trace.h"
 
 #include <osg/Notify>
+#include <osg/Timer>
+
+#include <OpenThreads/ScopedLock>
 
 #include <cassert>
 #include <vector>
@@ -30,7 +35,8 @@ Session::Session(System *system,
                  osgViewer::GraphicsWindow *window) :
     _window(window),
     _instance(system->getInstance()),
-    _system(system)
+    _system(system),
+    _spaceLocator(this)
 {
     XrSessionCreateInfo createInfo = { XR_TYPE_SESSION_CREATE_INFO };
     createInfo.systemId = getXrSystemId();
@@ -206,6 +212,7 @@ void Session::deactivateActionSet(ActionSet *actionSet, Path subactionPath)
 
 bool Session::syncActions()
 {
+    OSGXR_TRACE_SCOPE("Session::syncActions");
     if (!valid())
         return false;
 
@@ -238,6 +245,58 @@ bool Session::syncActions()
     }
 }
 
+void Session::registerActionState(ActionStateBase *state)
+{
+    unsigned int slot;
+    if (!_freeActionStateSlots.empty())
+    {
+        slot = _freeActionStateSlots.back();
+        _freeActionStateSlots.pop_back();
+        _actionStates[slot] = state;
+    }
+    else
+    {
+        slot = _actionStates.size();
+        _actionStates.push_back(state);
+    }
+    state->setSnapshotSlot(slot);
+}
+
+void Session::unregisterActionState(ActionStateBase *state)
+{
+    unsigned int slot = state->getSnapshotSlot();
+    assert(slot < _actionStates.size() && _actionStates[slot] == state);
+    _actionStates[slot] = nullptr;
+    _freeActionStateSlots.push_back(slot);
+}
+
+void Session::refreshActionStates()
+{
+    OSGXR_TRACE_SCOPE("Session::refreshActionStates");
+
+    // Reuse a snapshot no longer referenced by readers
+    ActionStateSnapshot *snapshot = _actionStateSnapshotPool.getUnused();
+    if (!snapshot)
+    {
+        snapshot = new ActionStateSnapshot();
+        _actionStateSnapshotPool.add(snapshot);
+    }
+
+    snapshot->reset(_actionStates.size(), _actionSyncCount);
+    for (auto *state: _actionStates)
+        if (state)
+            state->refresh(*snapshot);
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_actionStateSnapshotMutex);
+    _actionStateSnapshot = snapshot;
+}
+
+osg::ref_ptr<const ActionStateSnapshot> Session::getActionStateSnapshot() const
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_actionStateSnapshotMutex);
+    return _actionStateSnapshot;
+}
+
 const Session::SwapchainFormats &Session::getSwapchainFormats() const
 {
     if (!_readSwapchainFormats && valid())
@@ -489,6 +548,7 @@ void Session::requestExit()
 
 osg::ref_ptr<Session::Frame> Session::waitFrame()
 {
+    OSGXR_TRACE_SCOPE("Session::waitFrame");
     if (_instance->lost())
         return nullptr;
 
@@ -498,16 +558,40 @@ osg::ref_ptr<Session::Frame> Session::waitFrame()
     XrFrameState frameState;
     frameState.type = XR_TYPE_FRAME_STATE;
     frameState.next = nullptr;
+    osg::Timer_t startTick = osg::Timer::instance()->tick();
     if (check(xrWaitFrame(_session, &frameWaitInfo, &frameState),
               "wait for OpenXR frame"))
     {
-        frame = new Frame(this, &frameState);
+        {
+            // Recycle a frame that is no longer in use if possible
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_framePoolMutex);
+            frame = _framePool.getUnused();
+            if (frame.valid())
+            {
+                frame->reset(&frameState);
+            }
+            else
+            {
+                frame = new Frame(this, &frameState);
+                _framePool.add(frame.get());
+            }
+        }
+        frame->setWaitDuration(osg::Timer::instance()->delta_s(startTick,
+                                            osg::Timer::instance()->tick()));
+        // Locate views up front so they can be read without locking
+        frame->locateViews();
         _lastDisplayTime = frameState.predictedDisplayTime;
     }
 
     return frame;
 }
 
+void Session::releaseFramePool()
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_framePoolMutex);
+    _framePool.clear();
+}
+
 void Session::onEndFrame(Frame *frame)
 {
     if (_localSpace)
@@ -533,7 +617,12 @@ Session::Frame::Frame(osg::ref_ptr<Session> session, XrFrameState *frameState) :
     _period(frameState->predictedDisplayPeriod),
     _shouldRender(frameState->shouldRender),
     _osgFrameNumber(0),
-    _locatedViews(false),
+    _viewState{ XR_TYPE_VIEW_STATE },
+    _lateLatched(false),
+    _renderScale(1.0f),
+    _waitDuration(0.0),
+    _beginDuration(0.0),
+    _endDuration(0.0),
     _begun(false),
     _envBlendMode(XR_ENVIRONMENT_BLEND_MODE_MAX_ENUM)
 {
@@ -543,32 +632,76 @@ Session::Frame::~Frame()
 {
 }
 
+void Session::Frame::reset(XrFrameState *frameState)
+{
+    _time = frameState->predictedDisplayTime;
+    _period = frameState->predictedDisplayPeriod;
+    _shouldRender = frameState->shouldRender;
+    _osgFrameNumber = 0;
+    _viewState = { XR_TYPE_VIEW_STATE };
+    _lateLatched = false;
+    _renderScale = 1.0f;
+    _waitDuration = 0.0;
+    _beginDuration = 0.0;
+    _endDuration = 0.0;
+    _begun = false;
+    _envBlendMode = XR_ENVIRONMENT_BLEND_MODE_MAX_ENUM;
+    _layers.clear();
+}
+
 void Session::Frame::locateViews()
 {
+    locateViews(_viewState, _views);
+}
+
+bool Session::Frame::lateLatchViews()
+{
+    XrViewState viewState;
+    _lateLatched = false;
+    if (!locateViews(viewState, _lateLatchedViews))
+        return false;
+
+    // Only use fresh locations if they're complete
+    XrViewStateFlags required = XR_VIEW_STATE_ORIENTATION_VALID_BIT |
+                                XR_VIEW_STATE_POSITION_VALID_BIT;
+    if ((viewState.viewStateFlags & required) != required ||
+        _lateLatchedViews.size() != _views.size())
+        return false;
+
+    _lateLatched = true;
+    return true;
+}
+
+bool Session::Frame::locateViews(XrViewState &viewState,
+                                 std::vector<XrView> &views)
+{
+    OSGXR_TRACE_SCOPE("Frame::locateViews");
     // Get view locations
     XrViewLocateInfo locateInfo = { XR_TYPE_VIEW_LOCATE_INFO };
     locateInfo.viewConfigurationType = _session->getViewConfiguration()->getType();
     locateInfo.displayTime = _time;
     locateInfo.space = getLocalSpace()->getXrSpace();
 
-    _viewState = { XR_TYPE_VIEW_STATE };
+    viewState = { XR_TYPE_VIEW_STATE };
 
     uint32_t viewCount;
-    if (!check(xrLocateViews(_session->getXrSession(), &locateInfo, &_viewState, 0, &viewCount, nullptr),
+    if (!check(xrLocateViews(_session->getXrSession(), &locateInfo, &viewState, 0, &viewCount, nullptr),
                "count OpenXR views"))
     {
-        return;
+        return false;
     }
-    _views.resize(viewCount);
-    for (auto &view: _views)
+    views.resize(viewCount);
+    for (auto &view: views)
         view = { XR_TYPE_VIEW };
-    if (!check(xrLocateViews(_session->getXrSession(), &locateInfo, &_viewState, _views.size(), &viewCount, _views.data()),
+    if (!check(xrLocateViews(_session->getXrSession(), &locateInfo, &viewState, views.size(), &viewCount, views.data()),
                "locate OpenXR views"))
     {
-        return;
+        // Don't leave partial locations marked valid
+        viewState.viewStateFlags = 0;
+        return false;
     }
 
-    _locatedViews = true;
+    return true;
 }
 
 void Session::Frame::addLayer(osg::ref_ptr<CompositionLayer> layer)
@@ -578,27 +711,38 @@ void Session::Frame::addLayer(osg::ref_ptr<CompositionLayer> layer)
 
 bool Session::Frame::begin()
 {
+    OSGXR_TRACE_SCOPE("Frame::begin");
     XrFrameBeginInfo frameBeginInfo{ XR_TYPE_FRAME_BEGIN_INFO };
-    return _begun = check(xrBeginFrame(_session->getXrSession(), &frameBeginInfo),
-                          "begin OpenXR frame");
+    osg::Timer_t startTick = osg::Timer::instance()->tick();
+    _begun = check(xrBeginFrame(_session->getXrSession(), &frameBeginInfo),
+                   "begin OpenXR frame");
+    _beginDuration = osg::Timer::instance()->delta_s(startTick,
+                                            osg::Timer::instance()->tick());
+    return _begun;
 }
 
 bool Session::Frame::end()
 {
-    std::vector<const XrCompositionLayerBaseHeader *> layers;
-    layers.reserve(_layers.size());
+    OSGXR_TRACE_SCOPE("Frame::end");
+    _xrLayers.clear();
     for (auto &layer: _layers)
-        layers.push_back(layer->getXr());
+        _xrLayers.push_back(layer->getXr());
 
     XrFrameEndInfo frameEndInfo{ XR_TYPE_FRAME_END_INFO };
     frameEndInfo.displayTime = _time;
     frameEndInfo.environmentBlendMode = _envBlendMode;
-    frameEndInfo.layerCount = layers.size();
-    frameEndInfo.layers = layers.data();
+    frameEndInfo.layerCount = _xrLayers.size();
+    frameEndInfo.layers = _xrLayers.data();
 
     bool restoreContext = _session->shouldRestoreContext();
+    osg::Timer_t startTick = osg::Timer::instance()->tick();
     bool ret = check(xrEndFrame(_session->getXrSession(), &frameEndInfo),
                      "end OpenXR frame");
+    _endDuration = osg::Timer::instance()->delta_s(startTick,
+                                          osg::Timer::instance()->tick());
+
+    // Let the layers be recycled, keeping the capacity
+    _layers.clear();
 
     // Let session know the frame is done
     _session->onEndFrame(this);
@@ -608,3 +752,20 @@ bool Session::Frame::end()
 
     return ret;
 }
+
+bool Session::Frame::discard()
+{
+    OSGXR_TRACE_SCOPE("Frame::discard");
+    _layers.clear();
+    if (!_begun && !begin())
+        return false;
+
+    // A valid blend mode is required even without any layers
+    if (_envBlendMode == XR_ENVIRONMENT_BLEND_MODE_MAX_ENUM)
+    {
+        const auto &envBlendModes = _session->getViewConfiguration()->getEnvBlendModes();
+        if (!envBlendModes.empty())
+            _envBlendMode = envBlendModes[0];
+    }
+    return end();
+}
@@ -4,14 +4,18 @@
 #ifndef OSGXR_OPENXR_SESSION
 #define OSGXR_OPENXR_SESSION 1
 
+#include "ActionStateSnapshot.h"
 #include "ManagedSpace.h"
 #include "Path.h"
+#include "SpaceLocator.h"
 #include "System.h"
+#include "../ObjectPool.h"
 
 #include <osg/Geometry>
 #include <osg/Referenced>
 #include <osg/ref_ptr>
 #include <osgViewer/GraphicsWindow>
+
 #include <OpenThreads/Mutex>
 
 #include <memory>
@@ -23,6 +27,7 @@ namespace OpenXR {
 
 class Action;
 class ActionSet;
+class ActionStateBase;
 class CompositionLayer;
 
 class Session : public osg::Referenced
@@ -89,6 +94,28 @@ class Session : public osg::Referenced
             return _actionSyncCount;
         }
 
+        // Action state snapshots
+
+        /// Register an input action state, assigning it a snapshot slot.
+        void registerActionState(ActionStateBase *state);
+        /// Unregister an input action state, freeing its snapshot slot.
+        void unregisterActionState(ActionStateBase *state);
+        /**
+         * Read action states after a sync.
+         * This updates in one pass every registered action state which has
+         * been read since the previous call, and publishes a new snapshot of
+         * them, so that the app's reads of them which follow don't each need
+         * to call into the runtime.
+         */
+        void refreshActionStates();
+        /// Get the latest snapshot, from the thread syncing actions.
+        const ActionStateSnapshot *getLatestActionStateSnapshot() const
+        {
+            return _actionStateSnapshot.get();
+        }
+        /// Get the most recently published action state snapshot, if any.
+        osg::ref_ptr<const ActionStateSnapshot> getActionStateSnapshot() const;
+
         // Accessors
 
         // Find whether the session is ready to begin
@@ -164,6 +191,12 @@ class Session : public osg::Referenced
 
         typedef std::vector<int64_t> SwapchainFormats;
         const SwapchainFormats &getSwapchainFormats() const;
+        /// Use previously probed swapchain formats instead of enumerating.
+        void setSwapchainFormats(const SwapchainFormats &formats)
+        {
+            _swapchainFormats = formats;
+            _readSwapchainFormats = true;
+        }
 
         Space *getViewSpace();
         ManagedSpace *getLocalSpace();
@@ -173,6 +206,22 @@ class Session : public osg::Referenced
             return _lastDisplayTime;
         }
 
+        /**
+         * Locate a space, batched with other spaces located at the same time.
+         * Results are cached, so locating the same space relative to the same
+         * base space at the same time again is cheap.
+         */
+        bool locateSpace(Space *space, const Space *baseSpace, XrTime time,
+                         Space::Location &location)
+        {
+            return _spaceLocator.locate(space, baseSpace, time, location);
+        }
+        /// Forget about a space which is being destroyed.
+        void forgetSpace(const Space *space)
+        {
+            _spaceLocator.forget(space);
+        }
+
         bool recenterLocalSpace();
 
         void updateVisibilityMasks(XrViewConfigurationType viewConfigurationType,
@@ -291,6 +340,14 @@ class Session : public osg::Referenced
 
                 virtual ~Frame();
 
+                /**
+                 * Reset a recycled frame for a new frame state.
+                 * This must only be used on frames which are no longer
+                 * referenced elsewhere. Containers keep their capacity so
+                 * that recycled frames don't need to allocate.
+                 */
+                void reset(XrFrameState *frameState);
+
                 // Error checking
 
                 bool check(XrResult result, const char *actionMsg) const
@@ -327,51 +384,122 @@ class Session : public osg::Referenced
                     return _time;
                 }
 
-                void locateViews();
+                XrDuration getPeriod() const
+                {
+                    return _period;
+                }
 
-                void checkLocateViews()
+                /**
+                 * Set the fraction of each view's sub-image to render.
+                 * Views are scaled towards the swapchain origin, and the
+                 * scaled sub-images are submitted to the compositor.
+                 */
+                void setRenderScale(float scale)
+                {
+                    _renderScale = scale;
+                }
+                float getRenderScale() const
                 {
-                    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_locateViewsMutex);
-                    if (!_locatedViews)
-                        locateViews();
+                    return _renderScale;
                 }
 
-                bool isOrientationValid()
+                // Timings of XR calls in seconds
+
+                void setWaitDuration(double duration)
+                {
+                    _waitDuration = duration;
+                }
+                double getWaitDuration() const
+                {
+                    return _waitDuration;
+                }
+                double getBeginDuration() const
+                {
+                    return _beginDuration;
+                }
+                double getEndDuration() const
+                {
+                    return _endDuration;
+                }
+
+                /**
+                 * Locate the views for this frame's predicted display time.
+                 * This is done once by Session::waitFrame() before the frame
+                 * is made available to other threads, after which the view
+                 * locations are immutable and can be read without locking.
+                 */
+                void locateViews();
+
+                bool isOrientationValid() const
                 {
-                    checkLocateViews();
                     return _viewState.viewStateFlags & XR_VIEW_STATE_ORIENTATION_VALID_BIT;
                 }
-                bool isPositionValid()
+                bool isPositionValid() const
                 {
-                    checkLocateViews();
                     return _viewState.viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT;
                 }
-                bool isOrientationTracked()
+                bool isOrientationTracked() const
                 {
-                    checkLocateViews();
                     return _viewState.viewStateFlags & XR_VIEW_STATE_ORIENTATION_TRACKED_BIT;
                 }
-                bool isPositionTracked()
+                bool isPositionTracked() const
                 {
-                    checkLocateViews();
                     return _viewState.viewStateFlags & XR_VIEW_STATE_POSITION_TRACKED_BIT;
                 }
-                uint32_t getNumViews()
+                uint32_t getNumViews() const
                 {
-                    checkLocateViews();
                     return _views.size();
                 }
-                const XrFovf &getViewFov(uint32_t index)
+                const XrFovf &getViewFov(uint32_t index) const
                 {
-                    checkLocateViews();
                     return _views[index].fov;
                 }
-                const XrPosef &getViewPose(uint32_t index)
+                const XrPosef &getViewPose(uint32_t index) const
                 {
-                    checkLocateViews();
                     return _views[index].pose;
                 }
 
+                /**
+                 * Re-locate the views just before drawing for late latching.
+                 * This locates the views again for the same predicted display
+                 * time, giving a fresher prediction, without disturbing the
+                 * immutable view locations from locateViews(). It must only be
+                 * used from the draw thread.
+                 * @return true if fresh valid locations are available.
+                 */
+                bool lateLatchViews();
+                /// Discard late latched views, e.g. if they couldn't be used.
+                void discardLateLatchedViews()
+                {
+                    _lateLatched = false;
+                }
+                /// Find whether late latched view locations are in use.
+                bool isLateLatched() const
+                {
+                    return _lateLatched;
+                }
+                const XrFovf &getLateLatchedViewFov(uint32_t index) const
+                {
+                    return _lateLatchedViews[index].fov;
+                }
+                const XrPosef &getLateLatchedViewPose(uint32_t index) const
+                {
+                    return _lateLatchedViews[index].pose;
+                }
+
+                /// Get the view FOV that was rendered, for submission.
+                const XrFovf &getSubmitViewFov(uint32_t index) const
+                {
+                    return _lateLatched ? _lateLatchedViews[index].fov
+                                        : _views[index].fov;
+                }
+                /// Get the view pose that was rendered, for submission.
+                const XrPosef &getSubmitViewPose(uint32_t index) const
+                {
+                    return _lateLatched ? _lateLatchedViews[index].pose
+                                        : _views[index].pose;
+                }
+
                 // Modifiers
 
                 void setEnvBlendMode(XrEnvironmentBlendMode envBlendMode)
@@ -398,6 +526,13 @@ class Session : public osg::Referenced
 
                 bool begin();
                 bool end();
+                /**
+                 * Begin (if necessary) and end the frame with no layers.
+                 * A waited frame must be begun before the runtime will return
+                 * from the next xrWaitFrame, so this disposes of frames which
+                 * won't be rendered.
+                 */
+                bool discard();
 
             protected:
 
@@ -410,21 +545,39 @@ class Session : public osg::Referenced
                 // OpenSceneGraph frame
                 unsigned int _osgFrameNumber;
 
-                // For access to _locatedViews etc
-                OpenThreads::Mutex _locateViewsMutex;
+                bool locateViews(XrViewState &viewState,
+                                 std::vector<XrView> &views);
 
-                // View locations (protected by _locateViewsMutex)
-                bool _locatedViews;
+                // View locations (immutable once located)
                 XrViewState _viewState;
                 std::vector<XrView> _views;
 
+                // Late latched view locations (draw thread only)
+                bool _lateLatched;
+                std::vector<XrView> _lateLatchedViews;
+
+                // Dynamic resolution scale
+                float _renderScale;
+
+                // Timings
+                double _waitDuration;
+                double _beginDuration;
+                double _endDuration;
+
                 // Frame end info
                 bool _begun;
                 XrEnvironmentBlendMode _envBlendMode;
                 std::vector<osg::ref_ptr<CompositionLayer> > _layers;
+                std::vector<const XrCompositionLayerBaseHeader *> _xrLayers;
         };
 
         osg::ref_ptr<Frame> waitFrame();
+        /**
+         * Release recycled frames.
+         * Pooled frames reference the session, so this must be called before
+         * dropping the session.
+         */
+        void releaseFramePool();
         // Notify of end of frame
         void onEndFrame(Frame *frame);
         // Notify of reference space change
@@ -459,6 +612,14 @@ class Session : public osg::Referenced
         std::set<ActionSetSubactionPair> _activeActionSets;
         unsigned int _actionSyncCount = 0;
 
+        // Action states & snapshots of them
+        std::vector<ActionStateBase *> _actionStates;
+        std::vector<unsigned int> _freeActionStateSlots;
+        ObjectPool<ActionStateSnapshot> _actionStateSnapshotPool;
+        // Held while publishing a snapshot, for readers on other threads
+        mutable OpenThreads::Mutex _actionStateSnapshotMutex;
+        osg::ref_ptr<const ActionStateSnapshot> _actionStateSnapshot;
+
         // Session state
         XrSessionState _state = XR_SESSION_STATE_UNKNOWN;
         bool _running = false;
@@ -473,6 +634,12 @@ class Session : public osg::Referenced
         osg::ref_ptr<Space> _viewSpace;
         std::unique_ptr<ManagedSpace> _localSpace;
         XrTime _lastDisplayTime = 0;
+        // Batched locating of spaces
+        SpaceLocator _spaceLocator;
+
+        // Recycled frames
+        OpenThreads::Mutex _framePoolMutex;
+        ObjectPool<Frame> _framePool;
 
         /*
          * Visibility mask geometry cache.
@@ -65,6 +65,8 @@ Space::Space(Session *session, ActionPose *action,
 
 Space::~Space()
 {
+    if (_session.valid())
+        _session->forgetSpace(this);
     if (_session.valid() && _session->valid() && valid())
     {
         check(xrDestroySpace(_space),
@@ -91,6 +93,15 @@ Space::Location::Location(XrSpaceLocationFlags flags,
 {
 }
 
+Space::Location::Location(XrSpaceLocationFlags flags,
+                          const XrPosef &pose) :
+    _flags(flags),
+    _orientation(pose.orientation.x, pose.orientation.y,
+                 pose.orientation.z, pose.orientation.w),
+    _position(pose.position.x, pose.position.y, pose.position.z)
+{
+}
+
 bool Space::locate(const Space *baseSpace, XrTime time,
                    Space::Location &location)
 {
@@ -105,21 +116,8 @@ bool Space::locate(const Space *baseSpace, XrTime time,
                                    &spaceLocation),
                      "locate OpenXR space");
     if (ret)
-    {
-        osg::Quat orientation(spaceLocation.pose.orientation.x,
-                              spaceLocation.pose.orientation.y,
-                              spaceLocation.pose.orientation.z,
-                              spaceLocation.pose.orientation.w);
-        osg::Vec3f position(spaceLocation.pose.position.x,
-                            spaceLocation.pose.position.y,
-                            spaceLocation.pose.position.z);
-        location = Location(spaceLocation.locationFlags,
-                            orientation,
-                            position);
-    }
+        location = Location(spaceLocation.locationFlags, spaceLocation.pose);
     else
-    {
         location = Location();
-    }
     return ret;
 }
@@ -66,6 +66,8 @@ class Space : public osg::Referenced
                 Location(XrSpaceLocationFlags flags,
                          const osg::Quat &orientation,
                          const osg::Vec3f &position);
+                Location(XrSpaceLocationFlags flags,
+                         const XrPosef &pose);
 
                 // Error checking
 
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "SpaceLocator.h"
+#include "Session.h"
+#include "../Trace.h"
+
+#include <OpenThreads/ScopedLock>
+
+#include <algorithm>
+
+using namespace osgXR::OpenXR;
+
+SpaceLocator::SpaceLocator(Session *session) :
+    _session(session),
+    _baseSpace(nullptr),
+    _time(0)
+{
+}
+
+bool SpaceLocator::locate(Space *space, const Space *baseSpace, XrTime time,
+                          Space::Location &location)
+{
+    if (!space->valid())
+    {
+        location = Space::Location();
+        return false;
+    }
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+    if (baseSpace != _baseSpace || time != _time)
+    {
+        // Start a new batch with the spaces used in the last one
+        _entries.erase(std::remove_if(_entries.begin(), _entries.end(),
+                                      [](const Entry &entry) {
+                                          return !entry.used;
+                                      }),
+                       _entries.end());
+        _baseSpace = baseSpace;
+        _time = time;
+        locateBatch();
+    }
+
+    for (auto &entry: _entries)
+    {
+        if (entry.space == space)
+        {
+            entry.used = true;
+            location = entry.location;
+            return entry.located;
+        }
+    }
+
+    // Not in the batch yet, locate it alone and add it for next time
+    Entry entry;
+    entry.space = space;
+    entry.located = space->locate(baseSpace, time, entry.location);
+    entry.used = true;
+    _entries.push_back(entry);
+    location = entry.location;
+    return entry.located;
+}
+
+void SpaceLocator::forget(const Space *space)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+    if (space == _baseSpace)
+    {
+        // Results relative to it can't be reused
+        _baseSpace = nullptr;
+        _time = 0;
+    }
+    _entries.erase(std::remove_if(_entries.begin(), _entries.end(),
+                                  [space](const Entry &entry) {
+                                      return entry.space == space;
+                                  }),
+                   _entries.end());
+}
+
+void SpaceLocator::locateBatch()
+{
+    OSGXR_TRACE_SCOPE("SpaceLocator::locateBatch");
+
+    for (auto &entry: _entries)
+    {
+        entry.location = Space::Location();
+        entry.located = false;
+        entry.used = false;
+    }
+    if (_entries.empty() || !_baseSpace)
+        return;
+
+#ifdef XR_KHR_locate_spaces
+    const Instance *instance = _session->getInstance();
+    if (instance->hasLocateSpaces())
+    {
+        _xrSpaces.clear();
+        for (auto &entry: _entries)
+            _xrSpaces.push_back(entry.space->getXrSpace());
+        _xrLocations.resize(_entries.size());
+
+        XrSpacesLocateInfoKHR locateInfo{ XR_TYPE_SPACES_LOCATE_INFO_KHR };
+        locateInfo.baseSpace = _baseSpace->getXrSpace();
+        locateInfo.time = _time;
+        locateInfo.spaceCount = _xrSpaces.size();
+        locateInfo.spaces = _xrSpaces.data();
+
+        XrSpaceLocationsKHR locations{ XR_TYPE_SPACE_LOCATIONS_KHR };
+        locations.locationCount = _xrLocations.size();
+        locations.locations = _xrLocations.data();
+
+        if (_session->check(instance->xrLocateSpaces(_session->getXrSession(),
+                                                     &locateInfo, &locations),
+                            "locate OpenXR spaces"))
+        {
+            for (unsigned int i = 0; i < _entries.size(); ++i)
+            {
+                _entries[i].location = Space::Location(_xrLocations[i].locationFlags,
+                                                       _xrLocations[i].pose);
+                _entries[i].located = true;
+            }
+        }
+        return;
+    }
+#endif
+
+    // Fall back to locating each space individually
+    for (auto &entry: _entries)
+        entry.located = entry.space->locate(_baseSpace, _time,
+                                            entry.location);
+}
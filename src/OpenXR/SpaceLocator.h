@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_OPENXR_SPACE_LOCATOR
+#define OSGXR_OPENXR_SPACE_LOCATOR 1
+
+#include "Space.h"
+
+#include <OpenThreads/Mutex>
+
+#include <vector>
+
+namespace osgXR {
+
+namespace OpenXR {
+
+class Session;
+
+/**
+ * Locates spaces in batches, caching the results.
+ * Results are cached for a single base space and time, which in practice
+ * covers all the app's locates in a frame. When a new time is requested, all
+ * the spaces which were located at the previous time are located together,
+ * with a single xrLocateSpaces call if the runtime supports OpenXR 1.1 or
+ * XR_KHR_locate_spaces (and the OpenXR SDK is new enough to define it), so
+ * that repeated locates within a frame are free.
+ * Spaces which aren't located at one time are dropped from the next batch.
+ */
+class SpaceLocator
+{
+    public:
+
+        explicit SpaceLocator(Session *session);
+
+        /**
+         * Locate a space relative to a base space.
+         * @param space      Space to locate.
+         * @param baseSpace  Space to locate relative to.
+         * @param time       Time to locate at.
+         * @param location   Output location.
+         * @return true on success.
+         */
+        bool locate(Space *space, const Space *baseSpace, XrTime time,
+                    Space::Location &location);
+
+        /// Forget a space which is being destroyed.
+        void forget(const Space *space);
+
+    protected:
+
+        // Locate all the spaces in the batch
+        void locateBatch();
+
+        struct Entry
+        {
+            Space *space;
+            Space::Location location;
+            bool located;
+            // Whether located since the batch was last relocated
+            bool used;
+        };
+
+        Session *_session;
+        OpenThreads::Mutex _mutex;
+
+        // Current batch
+        const Space *_baseSpace;
+        XrTime _time;
+        std::vector<Entry> _entries;
+
+#ifdef XR_KHR_locate_spaces
+        // Reused xrLocateSpaces arrays
+        std::vector<XrSpace> _xrSpaces;
+        std::vector<XrSpaceLocationDataKHR> _xrLocations;
+#endif
+};
+
+} // osgXR::OpenXR
+
+} // osgXR
+
+#endif
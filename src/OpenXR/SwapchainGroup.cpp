@@ -2,6 +2,7 @@
 // Copyright (C) 2021 James Hogan <james@albanarts.com>
 
 #include "SwapchainGroup.h"
+#include "../Trace.h"
 
 #include <osg/Notify>
 
@@ -25,6 +26,7 @@ SwapchainGroup::~SwapchainGroup()
 
 int SwapchainGroup::acquireImages() const
 {
+    OSGXR_TRACE_SCOPE("SwapchainGroup::acquireImages");
     int imageIndex = _swapchain->acquireImage();
     if (depthValid())
     {
@@ -38,6 +40,7 @@ int SwapchainGroup::acquireImages() const
 
 bool SwapchainGroup::waitImages(XrDuration timeoutNs) const
 {
+    OSGXR_TRACE_SCOPE("SwapchainGroup::waitImages");
     bool ret = _swapchain->waitImage(timeoutNs);
     if (depthValid())
     {
@@ -49,6 +52,7 @@ bool SwapchainGroup::waitImages(XrDuration timeoutNs) const
 
 void SwapchainGroup::releaseImages() const
 {
+    OSGXR_TRACE_SCOPE("SwapchainGroup::releaseImages");
     _swapchain->releaseImage();
     if (depthValid())
         _depthSwapchain->releaseImage();
@@ -87,6 +87,27 @@ class SwapchainGroupSubImage
             return _arrayIndex;
         }
 
+        /// Scale a sub-image coordinate, consistently with scaled().
+        static uint32_t scaleCoord(uint32_t value, float scale)
+        {
+            return (uint32_t)(value * (double)scale);
+        }
+
+        /**
+         * Get a copy of the sub-image scaled towards the swapchain origin.
+         * This is used for dynamic resolution, where all views are rendered
+         * into a scaled down region of the swapchain images.
+         */
+        SwapchainGroupSubImage scaled(float scale) const
+        {
+            SwapchainGroupSubImage ret(*this);
+            ret._x = scaleCoord(_x, scale);
+            ret._y = scaleCoord(_y, scale);
+            ret._width = scaleCoord(_width, scale);
+            ret._height = scaleCoord(_height, scale);
+            return ret;
+        }
+
         void getXrSubImage(XrSwapchainSubImage *out) const
         {
             out->swapchain = _group->getXrSwapchain();
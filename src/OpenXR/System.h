@@ -226,6 +226,19 @@ class System
                 typedef std::vector<XrEnvironmentBlendMode> EnvBlendModes;
                 const EnvBlendModes &getEnvBlendModes() const;
 
+                /// Construct a view configuration from previously probed data.
+                ViewConfiguration(const System *system, XrViewConfigurationType type,
+                                  const Views &views,
+                                  const EnvBlendModes &envBlendModes) :
+                    _system(system),
+                    _type(type),
+                    _readViews(true),
+                    _views(views),
+                    _readEnvBlendModes(true),
+                    _envBlendModes(envBlendModes)
+                {
+                }
+
             protected:
 
                 bool check(XrResult result, const char *actionMsg) const
@@ -248,6 +261,13 @@ class System
         typedef std::vector<ViewConfiguration> ViewConfigurations;
         const ViewConfigurations &getViewConfigurations() const;
 
+        /// Use previously probed view configurations instead of enumerating.
+        void setViewConfigurations(const ViewConfigurations &viewConfigurations)
+        {
+            _viewConfigurations = viewConfigurations;
+            _readViewConfigurations = true;
+        }
+
     protected:
 
         // System data
@@ -31,7 +31,21 @@ Settings::Settings() :
     _alphaBits(-1),
     _depthBits(-1),
     _stencilBits(-1),
-    _unitsPerMeter(1.0f)
+    _mirrorDecimation(0),
+    _unitsPerMeter(1.0f),
+    _framesInFlight(2),
+    _framePacingThread(false),
+    _lateLatching(false),
+    _lateLatchingCullMargin(0.05f),
+    _dynamicResolution(false),
+    _dynamicResolutionMinScale(0.5f),
+    _dynamicResolutionMaxScale(1.0f),
+    _dynamicResolutionHysteresis(0.1f),
+    _idleFrameRate(0.0),
+    _multiViewCulling(false),
+    _sharedCulling(false),
+    _actionStateSnapshot(false),
+    _gpuTiming(false)
 {
 }
 
@@ -86,7 +100,27 @@ unsigned int Settings::_diff(const Settings &other) const
         ret |= DIFF_STENCIL_BITS;
     if (_mirrorSettings != other._mirrorSettings)
         ret |= DIFF_MIRROR;
+    if (_mirrorDecimation != other._mirrorDecimation)
+        ret |= DIFF_MIRROR_DECIMATION;
     if (_unitsPerMeter != other._unitsPerMeter)
         ret |= DIFF_SCALE;
+    if (_framesInFlight != other._framesInFlight)
+        ret |= DIFF_FRAMES_IN_FLIGHT;
+    if (_framePacingThread != other._framePacingThread)
+        ret |= DIFF_FRAME_PACING;
+    if (_lateLatching != other._lateLatching ||
+        _lateLatchingCullMargin != other._lateLatchingCullMargin)
+        ret |= DIFF_LATE_LATCHING;
+    if (_dynamicResolution != other._dynamicResolution ||
+        _dynamicResolutionMinScale != other._dynamicResolutionMinScale ||
+        _dynamicResolutionMaxScale != other._dynamicResolutionMaxScale ||
+        _dynamicResolutionHysteresis != other._dynamicResolutionHysteresis)
+        ret |= DIFF_DYNAMIC_RESOLUTION;
+    if (_multiViewCulling != other._multiViewCulling)
+        ret |= DIFF_MULTIVIEW_CULLING;
+    if (_sharedCulling != other._sharedCulling)
+        ret |= DIFF_SHARED_CULLING;
+    if (_gpuTiming != other._gpuTiming)
+        ret |= DIFF_GPU_TIMING;
     return ret;
 }
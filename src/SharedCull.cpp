@@ -0,0 +1,411 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "SharedCull.h"
+#include "Trace.h"
+#include "projection.h"
+
+#include <osg/Camera>
+#include <osg/CullingSet>
+#include <osg/Drawable>
+#include <osg/FrameStamp>
+#include <osg/Quat>
+#include <osg/Vec3>
+
+#include <osgUtil/CullVisitor>
+#include <osgUtil/PositionalStateContainer>
+#include <osgUtil/RenderLeaf>
+
+#include <osgViewer/View>
+#include <osgViewer/ViewerBase>
+
+#include <OpenThreads/ScopedLock>
+
+#include <algorithm>
+
+using namespace osgXR;
+
+class SharedCull::CullCallback : public osg::NodeCallback
+{
+    public:
+
+        CullCallback(SharedCull *sharedCull, uint32_t viewIndex,
+                     osg::Node *perViewNode) :
+            _sharedCull(sharedCull),
+            _viewIndex(viewIndex),
+            _perViewNode(perViewNode)
+        {
+        }
+
+        void operator()(osg::Node *node, osg::NodeVisitor *nv) override
+        {
+            osgUtil::CullVisitor *cv = nv->asCullVisitor();
+            osg::ref_ptr<SharedCull> sharedCull;
+            if (cv && _sharedCull.lock(sharedCull))
+            {
+                if (_viewIndex == 0)
+                {
+                    sharedCull->cullFirstView(this, node, cv);
+                    return;
+                }
+                if (sharedCull->copyFirstView(cv, _viewIndex))
+                {
+                    // Only this view's own nodes still need culling
+                    osg::ref_ptr<osg::Node> perViewNode;
+                    if (_perViewNode.lock(perViewNode))
+                        perViewNode->accept(*nv);
+                    return;
+                }
+            }
+            traverse(node, nv);
+        }
+
+    protected:
+
+        osg::observer_ptr<SharedCull> _sharedCull;
+        uint32_t _viewIndex;
+        osg::observer_ptr<osg::Node> _perViewNode;
+};
+
+class SharedCull::PerViewCallback : public osg::NodeCallback
+{
+    public:
+
+        explicit PerViewCallback(osg::StateSet *stateSet) :
+            _stateSet(stateSet)
+        {
+        }
+
+        void operator()(osg::Node *node, osg::NodeVisitor *nv) override
+        {
+            osgUtil::CullVisitor *cv = nv->asCullVisitor();
+            if (!cv)
+            {
+                traverse(node, nv);
+                return;
+            }
+            cv->pushStateSet(_stateSet.get());
+            traverse(node, nv);
+            cv->popStateSet();
+        }
+
+    protected:
+
+        osg::ref_ptr<osg::StateSet> _stateSet;
+};
+
+static osg::Matrix poseMatrix(const XrPosef &pose, float unitsPerMeter)
+{
+    osg::Vec3 position(pose.position.x,
+                       pose.position.y,
+                       pose.position.z);
+    osg::Quat orientation(pose.orientation.x,
+                          pose.orientation.y,
+                          pose.orientation.z,
+                          pose.orientation.w);
+    osg::Matrix matrix;
+    matrix.setTrans(position * unitsPerMeter);
+    matrix.preMultRotate(orientation);
+    return matrix;
+}
+
+SharedCull::SharedCull(const OpenXR::Session *session, unsigned int numViews) :
+    _multiView(MultiView::create(session)),
+    _cameras(numViews),
+    _perViewStateSet(new osg::StateSet)
+{
+}
+
+void SharedCull::update(osg::View &view, OpenXR::Session::Frame *frame,
+                        float unitsPerMeter)
+{
+    unsigned int frameNumber = view.getFrameStamp()->getFrameNumber();
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+        if (_frameViews.frameNumber == frameNumber)
+            return;
+    }
+
+    // Cameras culled in parallel can't wait for the first view, so leave
+    // them to cull normally
+    auto *viewerView = dynamic_cast<osgViewer::View *>(&view);
+    if (viewerView && viewerView->getViewerBase() &&
+        viewerView->getViewerBase()->getThreadingModel() ==
+                osgViewer::ViewerBase::CullThreadPerCameraDrawThreadPerContext)
+        return;
+
+    if (!_multiView.valid() ||
+        !frame->isPositionValid() || !frame->isOrientationValid())
+        return;
+    _multiView->loadFrame(frame);
+    MultiView::SharedView sharedView;
+    if (!_multiView->getSharedView(sharedView))
+        return;
+
+    FrameViews frameViews;
+    frameViews.frameNumber = frameNumber;
+
+    // Eye offsets of each view from the first
+    osg::Matrix firstPose = poseMatrix(frame->getViewPose(0), unitsPerMeter);
+    frameViews.viewOffsets.resize(_cameras.size());
+    for (unsigned int i = 0; i < _cameras.size(); ++i)
+        frameViews.viewOffsets[i] = firstPose *
+            osg::Matrix::inverse(poseMatrix(frame->getViewPose(i),
+                                            unitsPerMeter));
+
+    // Sides of the enclosing frustum, the near and far planes don't matter
+    osg::Matrix sharedProjection;
+    createProjectionFov(sharedProjection, sharedView.fov, 1.0f, 2.0f);
+    osg::Polytope enclosing;
+    enclosing.setToUnitFrustum(false, false);
+    enclosing.transformProvidingInverse(sharedProjection);
+    enclosing.transformProvidingInverse(firstPose *
+        osg::Matrix::inverse(poseMatrix(sharedView.pose, unitsPerMeter)));
+    frameViews.cullPlanes = enclosing.getPlaneList();
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+    _frameViews = frameViews;
+}
+
+osg::ref_ptr<osg::NodeCallback> SharedCull::createCullCallback(osg::Camera *camera,
+                                                               uint32_t viewIndex,
+                                                               osg::Node *perViewNode)
+{
+    if (viewIndex >= _cameras.size())
+        return nullptr;
+
+    // Only one scene camera per view can share
+    osg::ref_ptr<osg::Camera> existing;
+    if (_cameras[viewIndex].lock(existing) && existing != camera)
+        return nullptr;
+    _cameras[viewIndex] = camera;
+
+    return new CullCallback(this, viewIndex, perViewNode);
+}
+
+osg::ref_ptr<osg::NodeCallback> SharedCull::createPerViewCallback()
+{
+    return new PerViewCallback(_perViewStateSet.get());
+}
+
+void SharedCull::cullFirstView(osg::NodeCallback *callback, osg::Node *node,
+                               osgUtil::CullVisitor *cv)
+{
+    OSGXR_TRACE_SCOPE("SharedCull::cullFirstView");
+
+    unsigned int frameNumber = cv->getFrameStamp()->getFrameNumber();
+    osg::Polytope::PlaneList cullPlanes;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+        if (_frameViews.frameNumber == frameNumber)
+            cullPlanes = _frameViews.cullPlanes;
+        // The previous frame's render graph is about to be reused
+        _firstView = FirstView();
+    }
+
+    if (cullPlanes.size() != 4 || cv->getProjectionCullingStack().empty() ||
+        cv->getProjectionCullingStack().back().getFrustum().getPlaneList().size() < 4)
+    {
+        callback->traverse(node, cv);
+        return;
+    }
+
+    // Record where the shared part of the render graph starts
+    FirstView firstView;
+    firstView.frameNumber = frameNumber;
+    firstView.renderStage = cv->getRenderStage();
+    firstView.stateGraph = cv->getCurrentStateGraph();
+    firstView.projection = cv->getProjectionMatrix();
+    osgUtil::PositionalStateContainer *positional =
+            firstView.renderStage->getPositionalStateContainer();
+    firstView.numAttrs = positional->getAttrMatrixList().size();
+    for (auto &unit: positional->getTexUnitAttrMatrixListMap())
+        firstView.numTexAttrs[unit.first] = unit.second.size();
+
+    // Replace this view's frustum with the enclosing frustum while the scene
+    // is culled. It is rebuilt from just the enclosing sides and near/far, as
+    // other planes added by outer callbacks (such as this view's visibility
+    // mask corners) don't apply to the other views sharing the result.
+    osg::CullingSet &projectionSet = cv->getProjectionCullingStack().back();
+    osg::CullingSet &modelViewSet = cv->getCurrentCullingSet();
+    osg::Polytope projectionFrustum = projectionSet.getFrustum();
+    osg::Polytope modelViewFrustum = modelViewSet.getFrustum();
+
+    osg::CullSettings::CullingMode cullingMode = cv->getCullingMode();
+    osg::Polytope sharedFrustum;
+    sharedFrustum.setToUnitFrustum((cullingMode & osg::CullSettings::NEAR_PLANE_CULLING) != 0,
+                                   (cullingMode & osg::CullSettings::FAR_PLANE_CULLING) != 0);
+    sharedFrustum.transformProvidingInverse(*cv->getProjectionMatrix());
+    osg::Polytope::PlaneList planes = sharedFrustum.getPlaneList();
+    std::copy(cullPlanes.begin(), cullPlanes.end(), planes.begin());
+    osg::Polytope enclosing;
+    enclosing.set(planes);
+    projectionSet.getFrustum().set(planes);
+    enclosing.transformProvidingInverse(*cv->getModelViewMatrix());
+    modelViewSet.getFrustum().set(enclosing.getPlaneList());
+
+    callback->traverse(node, cv);
+
+    // Restore the original frustums
+    projectionSet.getFrustum() = projectionFrustum;
+    modelViewSet.getFrustum() = modelViewFrustum;
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+    _firstView = firstView;
+}
+
+osgUtil::StateGraph *SharedCull::mirrorStateGraph(osgUtil::StateGraph *stateGraph,
+                                                  const osgUtil::StateGraph *srcRoot,
+                                                  osgUtil::StateGraph *dstRoot) const
+{
+    if (stateGraph == srcRoot)
+        return dstRoot;
+    if (!stateGraph->_parent ||
+        stateGraph->getStateSet() == _perViewStateSet.get())
+        return nullptr; // not part of the shared scene
+
+    osgUtil::StateGraph *parent = mirrorStateGraph(stateGraph->_parent,
+                                                   srcRoot, dstRoot);
+    if (!parent)
+        return nullptr;
+    return parent->find_or_insert(stateGraph->getStateSet());
+}
+
+bool SharedCull::copyFirstView(osgUtil::CullVisitor *cv, uint32_t viewIndex)
+{
+    OSGXR_TRACE_SCOPE("SharedCull::copyFirstView");
+
+    unsigned int frameNumber = cv->getFrameStamp()->getFrameNumber();
+    FirstView firstView;
+    osg::Matrix viewOffset;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+        if (_firstView.frameNumber != frameNumber ||
+            _frameViews.frameNumber != frameNumber ||
+            viewIndex >= _frameViews.viewOffsets.size())
+            return false;
+        firstView = _firstView;
+        viewOffset = _frameViews.viewOffsets[viewIndex];
+    }
+
+    osgUtil::RenderStage *renderStage = cv->getRenderStage();
+    osgUtil::StateGraph *stateGraph = cv->getCurrentStateGraph();
+    osg::RefMatrix *projection = cv->getProjectionMatrix();
+    bool computeNearFar = (cv->getComputeNearFarMode() !=
+                           osg::CullSettings::DO_NOT_COMPUTE_NEAR_FAR);
+
+    // Move modelview matrices from the first view's eye space into this
+    // view's. The results come from the cull visitor's pool, and runs of
+    // leaves with the same modelview share the result like the originals.
+    const osg::RefMatrix *lastModelView = nullptr;
+    osg::RefMatrix *lastTransformed = nullptr;
+    auto transform = [&](osg::RefMatrix *modelView) -> osg::RefMatrix *
+    {
+        if (!modelView)
+            return nullptr;
+        if (modelView != lastModelView)
+        {
+            lastModelView = modelView;
+            lastTransformed = cv->createOrReuseMatrix(*modelView * viewOffset);
+        }
+        return lastTransformed;
+    };
+
+    // Leaves are grouped by state graph, so remember the last one mirrored
+    osgUtil::StateGraph *lastSrcParent = nullptr;
+    osgUtil::StateGraph *lastDstParent = nullptr;
+    auto copyLeaf = [&](osgUtil::RenderLeaf *leaf, osgUtil::RenderBin *bin)
+    {
+        if (leaf->_parent != lastSrcParent)
+        {
+            lastSrcParent = leaf->_parent;
+            lastDstParent = mirrorStateGraph(leaf->_parent,
+                                             firstView.stateGraph.get(),
+                                             stateGraph);
+        }
+        osgUtil::StateGraph *parent = lastDstParent;
+        if (!parent)
+            return;
+
+        // Leaves come from the cull visitor's pool rather than the heap
+        osg::Drawable *drawable = leaf->getDrawable();
+        osgUtil::RenderLeaf *copy;
+        if (leaf->_projection == firstView.projection)
+        {
+            osg::RefMatrix *modelView = transform(leaf->_modelview.get());
+            float depth = leaf->_depth;
+            const osg::BoundingBox &bb = drawable->getBoundingBox();
+            if (modelView && bb.valid())
+            {
+                depth = -(bb.center() * *modelView).z();
+                if (computeNearFar)
+                    cv->updateCalculatedNearFar(*modelView, *drawable, false);
+            }
+            copy = cv->createOrReuseRenderLeaf(drawable, projection, modelView,
+                                               depth);
+        }
+        else
+        {
+            // Under a nested projection, not relative to the view
+            copy = cv->createOrReuseRenderLeaf(drawable, leaf->_projection.get(),
+                                               leaf->_modelview.get(),
+                                               leaf->_depth);
+        }
+        copy->_traversalOrderNumber = leaf->_traversalOrderNumber;
+
+        if (parent->leaves_empty())
+            bin->addStateGraph(parent);
+        parent->addLeaf(copy);
+    };
+
+    // Copy bins, the leaves of sorted bins have already been moved out of
+    // their state graphs
+    std::vector<std::pair<osgUtil::RenderBin *, osgUtil::RenderBin *>> bins;
+    bins.emplace_back(firstView.renderStage.get(), renderStage);
+    while (!bins.empty())
+    {
+        osgUtil::RenderBin *src = bins.back().first;
+        osgUtil::RenderBin *dst = bins.back().second;
+        bins.pop_back();
+
+        for (auto &child: src->getRenderBinList())
+        {
+            // Create the same kind of bin, apps may register their own
+            const char *binName = child.second->className();
+            if (!osgUtil::RenderBin::getRenderBinPrototype(binName))
+                binName = "RenderBin";
+            osgUtil::RenderBin *dstChild = dst->find_or_insert(child.first,
+                                                               binName);
+            if (!dstChild)
+                continue;
+            dstChild->setSortMode(child.second->getSortMode());
+            dstChild->setSortCallback(child.second->getSortCallback());
+            dstChild->setDrawCallback(child.second->getDrawCallback());
+            bins.emplace_back(child.second.get(), dstChild);
+        }
+        for (auto *srcStateGraph: src->getStateGraphList())
+            for (auto &leaf: srcStateGraph->_leaves)
+                copyLeaf(leaf.get(), dst);
+        for (auto *leaf: src->getRenderLeafList())
+            copyLeaf(leaf, dst);
+    }
+
+    // Copy positional state found in the scene, such as light sources
+    osgUtil::PositionalStateContainer *positional =
+            firstView.renderStage->getPositionalStateContainer();
+    auto &attrs = positional->getAttrMatrixList();
+    for (unsigned int i = firstView.numAttrs; i < attrs.size(); ++i)
+        renderStage->addPositionedAttribute(transform(attrs[i].second.get()),
+                                            attrs[i].first);
+    for (auto &unit: positional->getTexUnitAttrMatrixListMap())
+    {
+        auto it = firstView.numTexAttrs.find(unit.first);
+        unsigned int start = (it != firstView.numTexAttrs.end()) ? it->second : 0;
+        for (unsigned int i = start; i < unit.second.size(); ++i)
+            renderStage->addPositionedTextureAttribute(unit.first,
+                                                       transform(unit.second[i].second.get()),
+                                                       unit.second[i].first);
+    }
+
+    return true;
+}
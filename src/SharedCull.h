@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_SHARED_CULL
+#define OSGXR_SHARED_CULL 1
+
+#include "MultiView.h"
+#include "OpenXR/Session.h"
+
+#include <osg/Callback>
+#include <osg/Matrix>
+#include <osg/Polytope>
+#include <osg/Referenced>
+#include <osg/StateSet>
+#include <osg/View>
+#include <osg/observer_ptr>
+#include <osg/ref_ptr>
+
+#include <osgUtil/RenderStage>
+#include <osgUtil/StateGraph>
+
+#include <OpenThreads/Mutex>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace osg {
+    class Camera;
+};
+
+namespace osgUtil {
+    class CullVisitor;
+};
+
+namespace osgXR {
+
+/**
+ * Shares a single cull traversal between the scene cameras of slave cameras
+ * mode.
+ * The scene camera of the first view culls the scene against a frustum
+ * enclosing all views (from MultiView), and the scene cameras of the other
+ * views copy its render graph instead of traversing the scene themselves,
+ * transforming each leaf into their own eye space. Each camera still draws
+ * with its own view and projection.
+ *
+ * Nodes specific to one view (such as visibility masks) are kept out of the
+ * shared render graph by tagging them with createPerViewCallback(). Render to
+ * texture cameras in the scene are only drawn by the first view, and cull
+ * callbacks which depend on the eye position only see the first view. If the
+ * first view's results aren't available for a frame (for example when scene
+ * cameras are culled in parallel threads), other views fall back to culling
+ * normally.
+ */
+class SharedCull : public osg::Referenced
+{
+    public:
+
+        SharedCull(const OpenXR::Session *session, unsigned int numViews);
+
+        /**
+         * Update view arrangement from a frame.
+         * Call from slave update callbacks, only the first call for each OSG
+         * frame has any effect.
+         */
+        void update(osg::View &view, OpenXR::Session::Frame *frame,
+                    float unitsPerMeter);
+
+        /**
+         * Create a cull callback for a view's scene camera.
+         * @param viewIndex   Index of XR view.
+         * @param perViewNode Optional child of the camera specific to this
+         *                    view, already tagged with
+         *                    createPerViewCallback().
+         * @return The new callback, or nullptr if the view already has a
+         *         scene camera sharing culling.
+         */
+        osg::ref_ptr<osg::NodeCallback> createCullCallback(osg::Camera *camera,
+                                                           uint32_t viewIndex,
+                                                           osg::Node *perViewNode);
+
+        /// Create a cull callback to keep a node out of the shared results.
+        osg::ref_ptr<osg::NodeCallback> createPerViewCallback();
+
+    protected:
+
+        class CullCallback;
+        class PerViewCallback;
+
+        /// Cull the first view against the enclosing frustum.
+        void cullFirstView(osg::NodeCallback *callback, osg::Node *node,
+                           osgUtil::CullVisitor *cv);
+
+        /// Copy the first view's results into another view's render graph.
+        bool copyFirstView(osgUtil::CullVisitor *cv, uint32_t viewIndex);
+
+        // Mirror a state graph from the first view's render graph
+        osgUtil::StateGraph *mirrorStateGraph(osgUtil::StateGraph *stateGraph,
+                                              const osgUtil::StateGraph *srcRoot,
+                                              osgUtil::StateGraph *dstRoot) const;
+
+        // View arrangement of a frame (protected by _mutex)
+        struct FrameViews
+        {
+            unsigned int frameNumber = ~0u;
+            // Sides of the enclosing frustum in first view eye space
+            osg::Polytope::PlaneList cullPlanes;
+            // Transforms from first view eye space to each view eye space
+            std::vector<osg::Matrix> viewOffsets;
+        };
+
+        // Render graph of the first view (protected by _mutex)
+        struct FirstView
+        {
+            unsigned int frameNumber = ~0u;
+            osg::ref_ptr<osgUtil::RenderStage> renderStage;
+            osg::ref_ptr<osgUtil::StateGraph> stateGraph;
+            osg::ref_ptr<osg::RefMatrix> projection;
+            // Positional state from before the scene was traversed
+            unsigned int numAttrs = 0;
+            std::map<unsigned int, unsigned int> numTexAttrs;
+        };
+
+        osg::ref_ptr<MultiView> _multiView;
+
+        OpenThreads::Mutex _mutex;
+        FrameViews _frameViews;
+        FirstView _firstView;
+
+        // Scene camera sharing culling for each view
+        std::vector<osg::observer_ptr<osg::Camera>> _cameras;
+
+        // Pushed around per-view nodes to identify their state graphs
+        osg::ref_ptr<osg::StateSet> _perViewStateSet;
+};
+
+} // osgXR
+
+#endif
@@ -63,8 +63,8 @@ bool Space::Private::locate(Pose &pose)
     OpenXR::Session *session = _space->getSession();
     OpenXR::Space::Location loc;
     XrTime time = session->getLastDisplayTime();
-    bool ret = _space->locate(session->getLocalSpace(time), time,
-                              loc);
+    bool ret = session->locateSpace(_space, session->getLocalSpace(time),
+                                    time, loc);
     pose = Pose((Pose::Flags)loc.getFlags(),
                 loc.getOrientation(),
                 loc.getPosition());
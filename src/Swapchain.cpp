@@ -219,7 +219,8 @@ bool Swapchain::Private::setup(XRState *state, OpenXR::Session *session)
     }
 
     OpenXR::System::ViewConfiguration::View view(_width, _height);
-    int64_t rgbaFormat = state->chooseRGBAFormat(_rgbBits, _alphaBits,
+    int64_t rgbaFormat = state->chooseRGBAFormat(session->getSwapchainFormats(),
+                                                 _rgbBits, _alphaBits,
                                                  _preferredRGBEncodingMask,
                                                  _allowedRGBEncodingMask);
     if (!rgbaFormat)
@@ -0,0 +1,222 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "Trace.h"
+
+#include <osg/Notify>
+
+#ifdef OSGXR_TRACING
+
+#include <osg/os_utils>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+
+#endif // OSGXR_TRACING
+
+using namespace osgXR;
+
+#ifdef OSGXR_TRACING
+
+namespace {
+
+/*
+ * Each thread records spans into its own ring buffer with no locking. Each
+ * event has a sequence number which is cleared while it is being written, so
+ * that writeTrace() can detect and skip events overwritten while reading.
+ */
+
+struct Event
+{
+    std::atomic<uint64_t> seq;
+    const char *name;
+    osg::Timer_t start;
+    osg::Timer_t end;
+};
+
+struct ThreadBuffer
+{
+    static constexpr unsigned int capacity = 16384;
+
+    explicit ThreadBuffer(unsigned int threadId) :
+        tid(threadId),
+        head(0)
+    {
+        for (auto &event: events)
+            event.seq.store(0, std::memory_order_relaxed);
+    }
+
+    unsigned int tid;
+    // Number of events ever written
+    std::atomic<uint64_t> head;
+    Event events[capacity];
+};
+
+// Buffers are kept until exit so that spans of finished threads are retained
+OpenThreads::Mutex buffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+thread_local ThreadBuffer *threadBuffer = nullptr;
+
+const osg::Timer_t epoch = osg::Timer::instance()->tick();
+
+ThreadBuffer *getThreadBuffer()
+{
+    if (!threadBuffer)
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+        buffers.emplace_back(new ThreadBuffer(buffers.size() + 1));
+        threadBuffer = buffers.back().get();
+    }
+    return threadBuffer;
+}
+
+} // anonymous namespace
+
+std::atomic<bool> Trace::enabled(false);
+
+void Trace::record(const char *name, osg::Timer_t start, osg::Timer_t end)
+{
+    ThreadBuffer *buffer = getThreadBuffer();
+    uint64_t index = buffer->head.load(std::memory_order_relaxed);
+    Event &event = buffer->events[index % ThreadBuffer::capacity];
+
+    event.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    event.seq.store(index + 1, std::memory_order_release);
+
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+namespace {
+
+// Enables tracing from startup if OSGXR_TRACE is set, writing it on exit
+class EnvTracer
+{
+    public:
+
+        EnvTracer()
+        {
+            if (osg::getEnvVar("OSGXR_TRACE", _filename) && !_filename.empty())
+                Trace::enabled.store(true);
+        }
+
+        ~EnvTracer()
+        {
+            if (!_filename.empty())
+                writeTrace(_filename);
+        }
+
+    protected:
+
+        std::string _filename;
+};
+
+EnvTracer envTracer;
+
+} // anonymous namespace
+
+// Public API
+
+bool osgXR::isTracingSupported()
+{
+    return true;
+}
+
+void osgXR::setTracing(bool enabled)
+{
+    Trace::enabled.store(enabled);
+}
+
+bool osgXR::getTracing()
+{
+    return Trace::enabled.load();
+}
+
+bool osgXR::writeTrace(const std::string &filename)
+{
+    std::ofstream out(filename);
+    if (!out)
+    {
+        OSG_WARN << "osgXR: Failed to open trace file \"" << filename << "\"" << std::endl;
+        return false;
+    }
+
+    osg::Timer *timer = osg::Timer::instance();
+    bool first = true;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+    for (auto &buffer: buffers)
+    {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t tail = 0;
+        if (head > ThreadBuffer::capacity)
+            tail = head - ThreadBuffer::capacity;
+        for (uint64_t index = tail; index < head; ++index)
+        {
+            Event &event = buffer->events[index % ThreadBuffer::capacity];
+            uint64_t seq = event.seq.load(std::memory_order_acquire);
+            const char *name = event.name;
+            osg::Timer_t start = event.start;
+            osg::Timer_t end = event.end;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // Skip events overwritten while reading
+            if (seq != index + 1 ||
+                event.seq.load(std::memory_order_relaxed) != seq)
+                continue;
+
+            out << (first ? "\n" : ",\n")
+                << "{\"name\":\"" << name << "\",\"cat\":\"osgXR\",\"ph\":\"X\""
+                << ",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"ts\":" << timer->delta_u(epoch, start)
+                << ",\"dur\":" << timer->delta_u(start, end) << "}";
+            first = false;
+        }
+    }
+
+    out << "\n]}\n";
+    if (!out)
+    {
+        OSG_WARN << "osgXR: Failed to write trace file \"" << filename << "\"" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#else // OSGXR_TRACING
+
+// Public API
+
+bool osgXR::isTracingSupported()
+{
+    return false;
+}
+
+void osgXR::setTracing(bool enabled)
+{
+    if (enabled)
+        OSG_WARN << "osgXR: Tracing not supported, build with OSGXR_TRACING" << std::endl;
+}
+
+bool osgXR::getTracing()
+{
+    return false;
+}
+
+bool osgXR::writeTrace(const std::string &filename)
+{
+    return false;
+}
+
+#endif // OSGXR_TRACING
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_TRACE
+#define OSGXR_TRACE 1
+
+#include <osgXR/Trace>
+
+#ifdef OSGXR_TRACING
+
+#include <osg/Timer>
+
+#include <atomic>
+
+namespace osgXR {
+
+namespace Trace {
+
+extern std::atomic<bool> enabled;
+
+/// Record a completed span on the current thread.
+void record(const char *name, osg::Timer_t start, osg::Timer_t end);
+
+/// Records a span covering the lifetime of the object.
+class Scope
+{
+    public:
+
+        explicit Scope(const char *name) :
+            _name(nullptr)
+        {
+            if (enabled.load(std::memory_order_relaxed))
+            {
+                _name = name;
+                _start = osg::Timer::instance()->tick();
+            }
+        }
+
+        ~Scope()
+        {
+            if (_name)
+                record(_name, _start, osg::Timer::instance()->tick());
+        }
+
+    protected:
+
+        const char *_name;
+        osg::Timer_t _start;
+};
+
+} // osgXR::Trace
+
+} // osgXR
+
+#define OSGXR_TRACE_CONCAT2(A, B) A##B
+#define OSGXR_TRACE_CONCAT(A, B) OSGXR_TRACE_CONCAT2(A, B)
+
+/// Trace the rest of the enclosing scope. NAME must be a string literal.
+#define OSGXR_TRACE_SCOPE(NAME) \
+    ::osgXR::Trace::Scope OSGXR_TRACE_CONCAT(_osgxrTraceScope, __LINE__)(NAME)
+
+#else // OSGXR_TRACING
+
+#define OSGXR_TRACE_SCOPE(NAME) ((void)0)
+
+#endif // OSGXR_TRACING
+
+#endif
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "VisibilityMaskCullCallback.h"
+
+#include <osg/Plane>
+
+#include <osgUtil/CullVisitor>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace osgXR;
+
+osg::ref_ptr<VisibilityMaskCullCallback> VisibilityMaskCullCallback::create(OpenXR::Session *session,
+                                                                             uint32_t viewIndex)
+{
+    // The boundary of the visible area is all that's needed, but the visible
+    // mesh covers the same area
+    osg::ref_ptr<osg::Geometry> mask;
+    mask = session->getVisibilityMask(viewIndex,
+                                      XR_VISIBILITY_MASK_TYPE_LINE_LOOP_KHR);
+    if (!mask.valid())
+        mask = session->getVisibilityMask(viewIndex,
+                                          XR_VISIBILITY_MASK_TYPE_VISIBLE_TRIANGLE_MESH_KHR);
+    if (!mask.valid())
+        return nullptr;
+    return new VisibilityMaskCullCallback(mask);
+}
+
+VisibilityMaskCullCallback::VisibilityMaskCullCallback(osg::Geometry *mask) :
+    _mask(mask)
+{
+}
+
+void VisibilityMaskCullCallback::operator()(osg::Node *node,
+                                            osg::NodeVisitor *nv)
+{
+    osgUtil::CullVisitor *cv = nv->asCullVisitor();
+    if (cv)
+        updatePlanes();
+    if (!cv || _planes.empty() || cv->getProjectionCullingStack().empty())
+    {
+        traverse(node, nv);
+        return;
+    }
+
+    // Nodes below transforms are culled against the projection culling set
+    // (in eye space) transformed by their modelview matrix, while nodes
+    // directly below the camera use the current modelview culling set
+    osg::CullingSet &projectionSet = cv->getProjectionCullingStack().back();
+    osg::CullingSet &modelViewSet = cv->getCurrentCullingSet();
+    osg::Polytope projectionFrustum = projectionSet.getFrustum();
+    osg::Polytope modelViewFrustum = modelViewSet.getFrustum();
+
+    osg::Polytope corners;
+    corners.set(_planes);
+    for (auto &plane: corners.getPlaneList())
+        projectionSet.getFrustum().add(plane);
+    corners.transformProvidingInverse(*cv->getModelViewMatrix());
+    for (auto &plane: corners.getPlaneList())
+        modelViewSet.getFrustum().add(plane);
+
+    traverse(node, nv);
+
+    // Restore the original frustums
+    projectionSet.getFrustum() = projectionFrustum;
+    modelViewSet.getFrustum() = modelViewFrustum;
+}
+
+void VisibilityMaskCullCallback::updatePlanes()
+{
+    const osg::Array *vertices = _mask->getVertexArray();
+    if (vertices == _vertices.get())
+        return;
+    _vertices = vertices;
+    _planes.clear();
+
+    // Vertices are view space tangents at unit distance in front of the view
+    auto *coords = dynamic_cast<const osg::Vec2Array *>(vertices);
+    if (!coords || coords->empty())
+        return;
+
+    // Bound the visible area with diagonal edges, which along with the
+    // rectangular frustum make an octagon
+    static const float diag = sqrtf(0.5f);
+    static const osg::Vec2f dirs[4] = {
+        osg::Vec2f( diag,  diag),
+        osg::Vec2f(-diag,  diag),
+        osg::Vec2f(-diag, -diag),
+        osg::Vec2f( diag, -diag),
+    };
+    for (auto &dir: dirs)
+    {
+        float extent = -FLT_MAX;
+        for (auto &coord: *coords)
+            extent = std::max(extent, dir * coord);
+        // Don't trust a mask which hides the view direction
+        if (extent <= 0.0f)
+            continue;
+
+        // Inside where dir . (x, y) / -z <= extent, with z < 0
+        osg::Plane plane(-dir.x(), -dir.y(), -extent, 0.0);
+        plane.makeUnitLength();
+        _planes.push_back(plane);
+    }
+}
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_VISIBILITY_MASK_CULL_CALLBACK
+#define OSGXR_VISIBILITY_MASK_CULL_CALLBACK 1
+
+#include "OpenXR/Session.h"
+
+#include <osg/Array>
+#include <osg/Callback>
+#include <osg/Geometry>
+#include <osg/Polytope>
+#include <osg/ref_ptr>
+
+#include <cstdint>
+
+namespace osgXR {
+
+/**
+ * Camera cull callback to skip objects hidden by a view's visibility mask.
+ * This derives an octagonal cone bounding the visible area of an OpenXR view
+ * from its visibility mask, and adds the planes which cut off the corners of
+ * the rectangular view frustum to the culling volume while the camera's
+ * children are culled. The camera must render a single view with its view
+ * matrix and projection matching the OpenXR view.
+ */
+class VisibilityMaskCullCallback : public osg::NodeCallback
+{
+    public:
+
+        /**
+         * Create a cull callback for an OpenXR view.
+         * @return The new callback, or nullptr if the view has no mask.
+         */
+        static osg::ref_ptr<VisibilityMaskCullCallback> create(OpenXR::Session *session,
+                                                               uint32_t viewIndex);
+
+        explicit VisibilityMaskCullCallback(osg::Geometry *mask);
+
+        void operator()(osg::Node *node, osg::NodeVisitor *nv) override;
+
+    protected:
+
+        /// Update eye space planes if the mask has changed.
+        void updatePlanes();
+
+        // Mask geometry, updated in place by the session on mask changes
+        osg::ref_ptr<osg::Geometry> _mask;
+        // Mask vertices the planes were derived from
+        osg::ref_ptr<const osg::Array> _vertices;
+
+        // Corner planes in eye space
+        osg::Polytope::PlaneList _planes;
+};
+
+} // osgXR
+
+#endif
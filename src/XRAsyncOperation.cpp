@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#include "XRAsyncOperation.h"
+
+using namespace osgXR;
+
+XRAsyncOperation::XRAsyncOperation(const std::string &name,
+                                   const Function &function) :
+    osg::GraphicsOperation(name, false),
+    _function(function),
+    _started(false),
+    _done(false)
+{
+}
+
+void XRAsyncOperation::operator () (osg::Object *object)
+{
+    // Operation threads without a graphics context pass no object
+    run();
+}
+
+void XRAsyncOperation::operator () (osg::GraphicsContext *gc)
+{
+    run();
+}
+
+void XRAsyncOperation::run()
+{
+    // Only ever run once
+    if (_started.exchange(true))
+        return;
+
+    _function();
+    _done.store(true, std::memory_order_release);
+}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: LGPL-2.1-only
+// Copyright (C) 2026 osgXR contributors
+
+#ifndef OSGXR_XRASYNCOPERATION
+#define OSGXR_XRASYNCOPERATION 1
+
+#include <osg/GraphicsThread>
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+namespace osgXR {
+
+/**
+ * Runs a function once on another thread.
+ * This can be queued on the graphics thread, allowing OpenXR calls which are
+ * sensitive to the GL context to be made from the thread which has it current
+ * without having to stop the viewer's threads, or on a plain operation thread
+ * for slow work which doesn't need the GL context at all. Completion can be
+ * polled for with isDone().
+ */
+class XRAsyncOperation : public osg::GraphicsOperation
+{
+    public:
+
+        typedef std::function<void ()> Function;
+
+        XRAsyncOperation(const std::string &name, const Function &function);
+
+        void operator () (osg::Object *object) override;
+        void operator () (osg::GraphicsContext *gc) override;
+
+        /**
+         * Run the function now if it hasn't been already.
+         * This is for when the graphics thread isn't running.
+         */
+        void run();
+
+        /// Find whether the function has completed.
+        bool isDone() const
+        {
+            return _done.load(std::memory_order_acquire);
+        }
+
+    protected:
+
+        Function _function;
+        std::atomic<bool> _started;
+        std::atomic<bool> _done;
+};
+
+} // osgXR
+
+#endif
@@ -8,6 +8,7 @@
 #include "AppViewSceneView.h"
 #include "AppViewGeomShaders.h"
 #include "AppViewOVRMultiview.h"
+#include "AppViewInstanced.h"
 #include "ActionSet.h"
 #include "CompositionLayer.h"
 #include "DebugCallbackOsg.h"
@@ -15,6 +16,7 @@
 #include "InteractionProfile.h"
 #include "Space.h"
 #include "Subaction.h"
+#include "Trace.h"
 
 #include <osgXR/Manager>
 
@@ -29,6 +31,7 @@
 #include <osg/RenderInfo>
 #include <osg/Shader>
 #include <osg/Texture>
+#include <osg/Timer>
 #include <osg/View>
 
 #include <osgUtil/SceneView>
@@ -37,6 +40,7 @@
 #include <osgViewer/Renderer>
 #include <osgViewer/View>
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cmath>
@@ -62,18 +66,51 @@ XRState::XRState(Settings *settings, Manager *manager) :
     _upDelay(0),
     _probing(false),
     _stateChanged(false),
+    _stoppingSession(false),
+    _stoppingSessionLoss(false),
+    _wasThreading(false),
+    _asyncOperationUp(false),
+    _asyncOperationGraphics(false),
+    _asyncUpResult(UP_SUCCESS),
     _probed(false),
     _useDepthInfo(false),
     _useVisibilityMask(false),
+    _useLateLatching(false),
     _formFactor(XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY),
     _system(nullptr),
     _chosenViewConfig(nullptr),
     _chosenEnvBlendMode(XR_ENVIRONMENT_BLEND_MODE_MAX_ENUM),
+    _probeCacheDirty(false),
+    _startupTick(0),
     _vrMode(VRMode::VRMODE_AUTOMATIC),
-    _swapchainMode(SwapchainMode::SWAPCHAIN_AUTOMATIC)
+    _swapchainMode(SwapchainMode::SWAPCHAIN_AUTOMATIC),
+    _gpuCameraSpan(-1),
+    _resolutionScale(1.0f),
+    _renderStartTick(0),
+    _idle(false),
+    _idleFrameRateLimited(false),
+    _savedMaxFrameRate(0.0),
+    _mirrorDecimation(0),
+    _savedSyncToVBlank(true),
+    _endedFrameNumber(~0u)
 {
 }
 
+XRState::~XRState()
+{
+    // Wait for any outstanding work on the worker thread, which refers back
+    // to this object, by draining its queue before stopping it
+    if (_worker.valid())
+    {
+        osg::ref_ptr<osg::BarrierOperation> barrier =
+            new osg::BarrierOperation(2, osg::BarrierOperation::NO_OPERATION,
+                                      false);
+        _worker->add(barrier.get());
+        barrier->block();
+        _worker->cancel();
+    }
+}
+
 XRState::XRSwapchain::XRSwapchain(XRState *state,
                                   osg::ref_ptr<OpenXR::Session> session,
                                   const OpenXR::System::ViewConfiguration::View &view,
@@ -90,7 +127,8 @@ XRState::XRSwapchain::XRSwapchain(XRState *state,
     _forcedAlpha(-1.0f),
     _numDrawPasses(0),
     _drawPassesDone(0),
-    _imagesReady(false)
+    _imagesReady(false),
+    _gpuSpan(-1)
 {
     if (valid())
     {
@@ -154,7 +192,10 @@ void XRState::XRSwapchain::setupImage(const osg::FrameStamp *stamp)
     if (firstPass)
     {
         // Acquire a swapchain image
+        osg::Timer_t startTick = osg::Timer::instance()->tick();
         imageIndex = acquireImages();
+        _state->_drawTimings.durations[FrameTimings::PHASE_SWAPCHAIN_ACQUIRE] +=
+            osg::Timer::instance()->delta_s(startTick, osg::Timer::instance()->tick());
         if (imageIndex < 0 || (unsigned int)imageIndex >= _imageFramebuffers.size())
         {
             OSG_WARN << "osgXR: Failure to acquire OpenXR swapchain image (got image index " << imageIndex << ")" << std::endl;
@@ -171,6 +212,12 @@ void XRState::XRSwapchain::preDrawCallback(osg::RenderInfo &renderInfo,
                                            unsigned int arrayIndex)
 {
     const osg::FrameStamp *stamp = renderInfo.getState()->getFrameStamp();
+
+    // Don't acquire images if the frame won't be displayed
+    OpenXR::Session::Frame *frame = _state->_frames.getFrame(stamp);
+    if (frame && !frame->shouldRender())
+        return;
+
     setupImage(stamp);
 
     auto opt_fbo = _imageFramebuffers[stamp];
@@ -183,10 +230,25 @@ void XRState::XRSwapchain::preDrawCallback(osg::RenderInfo &renderInfo,
     osg::State &state = *renderInfo.getState();
     fbo->bind(state, _state->_instance);
 
+    if (_state->_gpuTimer.valid())
+    {
+        // Time the draw pass into the views using this swapchain
+        uint32_t viewMask = 0;
+        for (unsigned int i = 0; i < _state->_xrViews.size(); ++i)
+            if (_state->_xrViews[i]->getSwapchain().get() == this)
+                viewMask |= 1u << i;
+        _gpuSpan = _state->_gpuTimer->beginSpan(state, GpuTimer::TARGET_SWAPCHAIN,
+                                                viewMask);
+    }
+
     if (!_imagesReady)
     {
         // Wait for the image to be ready to render into
-        if (!waitImages(100e6 /* 100ms */))
+        osg::Timer_t startTick = osg::Timer::instance()->tick();
+        bool waited = waitImages(100e6 /* 100ms */);
+        _state->_drawTimings.durations[FrameTimings::PHASE_SWAPCHAIN_WAIT] +=
+            osg::Timer::instance()->delta_s(startTick, osg::Timer::instance()->tick());
+        if (!waited)
         {
             OSG_WARN << "osgXR: Failure to wait for OpenXR swapchain image" << std::endl;
 
@@ -211,6 +273,12 @@ void XRState::XRSwapchain::postDrawCallback(osg::RenderInfo &renderInfo,
     // Unbind the framebuffer
     osg::State& state = *renderInfo.getState();
 
+    if (_gpuSpan >= 0)
+    {
+        _state->_gpuTimer->endSpan(state, _gpuSpan);
+        _gpuSpan = -1;
+    }
+
     if (++_drawPassesDone == _numDrawPasses && _imagesReady)
     {
         if (_forcedAlpha >= 0)
@@ -227,7 +295,10 @@ void XRState::XRSwapchain::postDrawCallback(osg::RenderInfo &renderInfo,
         fbo->unbind(state);
 
         // Done rendering. release the swapchain image
+        osg::Timer_t startTick = osg::Timer::instance()->tick();
         releaseImages();
+        _state->_drawTimings.durations[FrameTimings::PHASE_SWAPCHAIN_RELEASE] +=
+            osg::Timer::instance()->delta_s(startTick, osg::Timer::instance()->tick());
 
         _imagesReady = false;
     }
@@ -287,7 +358,9 @@ void XRState::XRView::endFrame(OpenXR::Session::Frame *frame)
     osg::ref_ptr<OpenXR::CompositionLayerProjection> proj = _state->getProjectionLayer();
     if (proj != nullptr)
     {
-        proj->addView(frame, _viewIndex, _swapchainSubImage,
+        // Only the scaled down region of the image was rendered
+        proj->addView(frame, _viewIndex,
+                      _swapchainSubImage.scaled(frame->getRenderScale()),
                       _state->_useDepthInfo ? &_state->_depthInfo : nullptr);
     }
     else
@@ -300,6 +373,7 @@ XRState::AppSubView::AppSubView(XRState::XRView *xrView,
                                 const osg::Matrix &viewMatrix,
                                 const osg::Matrix &projectionMatrix) :
     _xrView(xrView),
+    _resolutionScale(xrView->getResolutionScale()),
     _viewMatrix(viewMatrix),
     _projectionMatrix(projectionMatrix)
 {
@@ -312,11 +386,12 @@ unsigned int XRState::AppSubView::getArrayIndex() const
 
 View::SubView::Viewport XRState::AppSubView::getViewport() const
 {
+    auto subImage = _xrView->getSubImage().scaled(_resolutionScale);
     return View::SubView::Viewport{
-        (double)_xrView->getSubImage().getX(),
-        (double)_xrView->getSubImage().getY(),
-        (double)_xrView->getSubImage().getWidth(),
-        (double)_xrView->getSubImage().getHeight()
+        (double)subImage.getX(),
+        (double)subImage.getY(),
+        (double)subImage.getWidth(),
+        (double)subImage.getHeight()
     };
 }
 
@@ -550,7 +625,15 @@ void XRState::syncSettings()
                      Settings::DIFF_RGB_BITS |
                      Settings::DIFF_ALPHA_BITS |
                      Settings::DIFF_DEPTH_BITS |
-                     Settings::DIFF_STENCIL_BITS))
+                     Settings::DIFF_STENCIL_BITS |
+                     Settings::DIFF_FRAMES_IN_FLIGHT |
+                     Settings::DIFF_FRAME_PACING |
+                     Settings::DIFF_LATE_LATCHING |
+                     Settings::DIFF_GPU_TIMING |
+                     Settings::DIFF_DYNAMIC_RESOLUTION |
+                     Settings::DIFF_MIRROR_DECIMATION |
+                     Settings::DIFF_MULTIVIEW_CULLING |
+                     Settings::DIFF_SHARED_CULLING))
         // Recreate session
         setDownState(VRSTATE_SYSTEM);
 }
@@ -611,6 +694,7 @@ bool XRState::checkAndResetStateChanged()
 
 void XRState::update()
 {
+    OSGXR_TRACE_SCOPE("XRState::update");
     typedef UpResult (XRState::*UpHandler)();
     static UpHandler upStateHandlers[VRSTATE_MAX - 1] = {
         &XRState::upInstance,
@@ -630,15 +714,28 @@ void XRState::update()
     bool pollNeeded = true;
     for (;;)
     {
+        // A transition waiting on another thread must be finished first
+        bool pendingUp = _asyncOperation.valid() && _asyncOperationUp;
+        bool pendingDown = _asyncOperation.valid() && !_asyncOperationUp;
+
         // Poll first
-        if (pollNeeded && _instance.valid() && _instance->valid())
+        if (pollNeeded && !_asyncOperation.valid() &&
+            _instance.valid() && _instance->valid())
         {
+            // Finish stopping a session once frames allow
+            finishStoppingSession();
+
             // Poll for events
             _instance->pollEvents(this);
 
             // Sync actions
-            if (_session.valid())
-                _session->syncActions();
+            if (_session.valid() && _session->syncActions())
+            {
+                if (_settings->getActionStateSnapshot())
+                    _session->refreshActionStates();
+                for (auto *actionSet: _actionSets)
+                    actionSet->generateEvents(_actionEvents);
+            }
 
             // Check for session lost
             if (_session.valid() && _session->isLost())
@@ -651,7 +748,7 @@ void XRState::update()
             pollNeeded = false;
         }
         // Then down transitions
-        else if (_downState < _currentState)
+        else if (!pendingUp && (pendingDown || _downState < _currentState))
         {
             DownResult res = (this->*downStateHandlers[_currentState-1])();
             if (res == DOWN_SUCCESS)
@@ -667,9 +764,9 @@ void XRState::update()
             }
         }
         // Then up transitions
-        else if (_upState > _currentState)
+        else if (pendingUp || _upState > _currentState)
         {
-            if (_upDelay > 0)
+            if (_upDelay > 0 && !pendingUp)
             {
                 // try again soon
                 --_upDelay;
@@ -713,13 +810,81 @@ void XRState::update()
             break;
         }
     }
+}
 
-    // Restart threading in case we had to disable it to prevent the GL context
-    // being bound in another thread during certain OpenXR calls.
-    if (_viewer.valid() && _wasThreading)
+bool XRState::stopViewerThreading()
+{
+    if (!_viewer.valid() || !_viewer->areThreadsRunning())
+        return false;
+    _viewer->stopThreading();
+    return true;
+}
+
+void XRState::startViewerThreading()
+{
+    if (_viewer.valid())
         _viewer->startThreading();
 }
 
+bool XRState::startGraphicsOperation(const std::string &name, bool up,
+                                     const XRAsyncOperation::Function &function)
+{
+    assert(!_asyncOperation.valid());
+
+    // Without viewer threads the GL context isn't bound in another thread,
+    // so run it here with the context current
+    if (!_wasThreading)
+    {
+        bool current = _window.valid() && _window->makeCurrent();
+        function();
+        if (current)
+            _window->releaseContext();
+        return true;
+    }
+
+    _asyncOperation = new XRAsyncOperation(name, function);
+    _asyncOperationUp = up;
+    _asyncOperationGraphics = true;
+    _window->add(_asyncOperation.get());
+    return false;
+}
+
+void XRState::startWorkerOperation(const std::string &name, bool up,
+                                   const XRAsyncOperation::Function &function)
+{
+    assert(!_asyncOperation.valid());
+
+    if (!_worker.valid())
+    {
+        _worker = new osg::OperationThread;
+        _worker->startThread();
+    }
+
+    _asyncOperation = new XRAsyncOperation(name, function);
+    _asyncOperationUp = up;
+    _asyncOperationGraphics = false;
+    _worker->add(_asyncOperation.get());
+}
+
+bool XRState::finishAsyncOperation()
+{
+    if (!_asyncOperation->isDone())
+    {
+        // Still waiting for the graphics thread, unless it has since stopped
+        if (!_asyncOperationGraphics || _wasThreading)
+            return false;
+        // Run it here instead, with the GL context current
+        bool current = _window.valid() && _window->makeCurrent();
+        _asyncOperation->run();
+        if (current)
+            _window->releaseContext();
+        if (_window.valid())
+            _window->remove(_asyncOperation.get());
+    }
+    _asyncOperation = nullptr;
+    return true;
+}
+
 bool XRState::recenterLocalSpace()
 {
     if (!_session.valid())
@@ -747,6 +912,10 @@ void XRState::onInteractionProfileChanged(OpenXR::Session *session,
         if (subaction)
             subaction->onInteractionProfileChanged(session);
     }
+
+    // and action sets so they can invalidate cached bound sources
+    for (auto *actionSet: _actionSets)
+        actionSet->onInteractionProfileChanged();
 }
 
 void XRState::onReferenceSpaceChangePending(OpenXR::Session *session,
@@ -795,6 +964,17 @@ void XRState::onSessionStateReady(OpenXR::Session *session)
         return;
     }
 
+    // Start timing afresh for the new session
+    _frameTimer.reset();
+
+    // Start waiting for frames ahead of the viewer
+    if (_settingsCopy.getFramePacingThread())
+    {
+        _framePacer = new FramePacer(session);
+        _framePacer->startPacing();
+        _frames.setFramePacer(_framePacer.get());
+    }
+
     // Set up cameras
     switch (_vrMode)
     {
@@ -815,10 +995,21 @@ void XRState::onSessionStateReady(OpenXR::Session *session)
         case VRMode::VRMODE_OVR_MULTIVIEW:
             setupOVRMultiviewCameras();
             break;
+
+        case VRMode::VRMODE_INSTANCED:
+            setupInstancedCameras();
+            break;
     }
 
     // Attach a callback to detect swap
     osg::ref_ptr<osg::GraphicsContext> gc = _window.get();
+    _mirrorDecimation = _settingsCopy.getMirrorDecimation();
+    if (_mirrorDecimation)
+    {
+        // Don't let desktop vsync hold up XR frames
+        _savedSyncToVBlank = _window->getSyncToVBlank();
+        gc->add(new SyncToVBlankOperation(false));
+    }
     osg::ref_ptr<SwapCallback> swapCallback = new SwapCallback(this);
     gc->setSwapCallback(swapCallback);
 
@@ -835,19 +1026,56 @@ void XRState::onSessionStateStopping(OpenXR::Session *session, bool loss)
 {
     // check no frame in progress
 
+    // resume normal rendering & frame rate
+    setIdle(false);
+
     // clean up appViews
     for (auto appView: _appViews)
         appView->destroy();
     _appViews.resize(0);
+    _sharedCull = nullptr;
 
     osg::ref_ptr<osg::GraphicsContext> gc = _window.get();
     gc->setSwapCallback(nullptr);
+    if (_mirrorDecimation)
+    {
+        gc->add(new SyncToVBlankOperation(_savedSyncToVBlank));
+        _mirrorDecimation = 0;
+    }
+
+    // The frame pacing thread is stopped and the session ended once the
+    // previous frame has finished drawing, see finishStoppingSession()
+    _stoppingSession = true;
+    _stoppingSessionLoss = loss;
+    finishStoppingSession();
+}
+
+bool XRState::finishStoppingSession()
+{
+    if (!_stoppingSession)
+        return true;
+
+    // Stop the frame pacing thread before ending the session. It may be in
+    // xrWaitFrame waiting for the last frame it handed out to be begun, which
+    // won't happen now the cameras have gone, so discard those frames first.
+    // That can't be done while an earlier frame is still being drawn, so try
+    // again on a later update.
+    if (_framePacer.valid())
+    {
+        _frames.setFramePacer(nullptr);
+        if (!_frames.discardUnbegunFrames())
+            return false;
+        _framePacer->stopPacing();
+        _framePacer = nullptr;
+    }
+    _stoppingSession = false;
 
-    if (!loss)
-        session->end();
+    if (!_stoppingSessionLoss)
+        _session->end();
 
     if (_manager.valid())
         _manager->onStopped();
+    return true;
 }
 
 void XRState::onSessionStateFocus(OpenXR::Session *session)
@@ -888,9 +1116,24 @@ void XRState::unprobe() const
 
 XRState::UpResult XRState::upInstance()
 {
+    OSGXR_TRACE_SCOPE("XRState::upInstance");
+    // Wait for the instance to be created on the worker thread
+    if (_asyncOperation.valid())
+    {
+        if (!finishAsyncOperation())
+            return UP_SOON;
+        if (_asyncUpResult != UP_SUCCESS)
+        {
+            _instance->getError(_lastError);
+            _instance = nullptr;
+        }
+        return _asyncUpResult;
+    }
+
     assert(!_instance.valid());
 
     // Create OpenXR instance
+    _startupTick = osg::Timer::instance()->tick();
 
     // Update needed settings that may have changed
     _settingsCopy.setApp(_settings->getAppName(), _settings->getAppVersion());
@@ -920,18 +1163,32 @@ XRState::UpResult XRState::upInstance()
         if (extension->getAvailable())
             extension->setup(_instance);
 
-    switch (_instance->init(_settingsCopy.getAppName().c_str(),
-                            _settingsCopy.getAppVersion()))
+    // Runtimes can take a while to create an instance, so don't block. The
+    // worker gets its own copies of everything it reads.
+    OpenXR::Instance *instance = _instance.get();
+    std::string appName = _settingsCopy.getAppName();
+    uint32_t appVersion = _settingsCopy.getAppVersion();
+    startWorkerOperation("osgXR upInstance", true,
+                         [this, instance, appName, appVersion]() {
+                             _asyncUpResult = upInstanceWorker(instance, appName,
+                                                               appVersion);
+                         });
+    return UP_SOON;
+}
+
+XRState::UpResult XRState::upInstanceWorker(OpenXR::Instance *instance,
+                                            const std::string &appName,
+                                            uint32_t appVersion)
+{
+    OSGXR_TRACE_SCOPE("XRState::upInstanceWorker");
+
+    switch (instance->init(appName.c_str(), appVersion))
     {
     case OpenXR::Instance::INIT_SUCCESS:
         break;
     case OpenXR::Instance::INIT_LATER:
-        _instance->getError(_lastError);
-        _instance = nullptr;
         return UP_LATER;
     case OpenXR::Instance::INIT_FAIL:
-        _instance->getError(_lastError);
-        _instance = nullptr;
         return UP_ABORT;
     }
 
@@ -940,22 +1197,34 @@ XRState::UpResult XRState::upInstance()
 
 XRState::DownResult XRState::downInstance()
 {
+    OSGXR_TRACE_SCOPE("XRState::downInstance");
     assert(_instance.valid());
 
-    // This should destroy actions and action sets
-    for (auto *profile: _interactionProfiles)
-        profile->cleanupInstance();
-    for (auto *actionSet: _actionSets)
-        actionSet->cleanupInstance();
-
-    for (auto &pair: _subactions)
+    if (!_asyncOperation.valid())
     {
-        auto subaction = pair.second.lock();
-        if (subaction)
-            subaction->cleanupInstance();
+        // This should destroy actions and action sets
+        for (auto *profile: _interactionProfiles)
+            profile->cleanupInstance();
+        for (auto *actionSet: _actionSets)
+            actionSet->cleanupInstance();
+
+        for (auto &pair: _subactions)
+        {
+            auto subaction = pair.second.lock();
+            if (subaction)
+                subaction->cleanupInstance();
+        }
+
+        // Runtimes can take a while to destroy an instance, so don't block
+        OpenXR::Instance *instance = _instance.get();
+        startWorkerOperation("osgXR downInstance", false,
+                             [instance]() { instance->deinit(); });
+        return DOWN_SOON;
     }
 
-    _instance->deinit();
+    // Wait for the instance to be destroyed on the worker thread
+    if (!finishAsyncOperation())
+        return DOWN_SOON;
 
     if (_probed)
         unprobe();
@@ -971,82 +1240,149 @@ XRState::DownResult XRState::downInstance()
 
 XRState::UpResult XRState::upSystem()
 {
+    OSGXR_TRACE_SCOPE("XRState::upSystem");
+    // Wait for the system to be found on the worker thread
+    if (_asyncOperation.valid())
+    {
+        if (!finishAsyncOperation())
+            return UP_SOON;
+
+        // Publish what the worker found now it has finished with it
+        SystemResults &results = _systemResults;
+        _formFactor = results.formFactor;
+        if (_asyncUpResult == UP_SUCCESS)
+        {
+            _system = results.system;
+            _probeCache = results.probeCache;
+            _probeCacheDirty = results.probeCacheDirty;
+            _chosenViewConfig = results.chosenViewConfig;
+            _chosenEnvBlendMode = results.chosenEnvBlendMode;
+        }
+        results = SystemResults();
+        return _asyncUpResult;
+    }
+
     assert(!_system);
 
     // Update needed settings that may have changed
     _settingsCopy.setFormFactor(_settings->getFormFactor());
     _settingsCopy.setPreferredEnvBlendModeMask(_settings->getPreferredEnvBlendModeMask());
     _settingsCopy.setAllowedEnvBlendModeMask(_settings->getAllowedEnvBlendModeMask());
+    _settingsCopy.setProbeCacheFile(_settings->getProbeCacheFile());
+
+    // Some runtimes block while waiting for a system, so don't block. The
+    // worker gets its own copies of everything it reads, and writes only to
+    // _systemResults until upSystem() publishes them.
+    OpenXR::Instance *instance = _instance.get();
+    SystemInputs inputs;
+    inputs.formFactor = _settingsCopy.getFormFactor();
+    inputs.preferredEnvBlendModeMask = _settingsCopy.getPreferredEnvBlendModeMask();
+    inputs.allowedEnvBlendModeMask = _settingsCopy.getAllowedEnvBlendModeMask();
+    inputs.probeCacheFile = _settingsCopy.getProbeCacheFile();
+    _systemResults = SystemResults();
+    startWorkerOperation("osgXR upSystem", true,
+                         [this, instance, inputs]() {
+                             _asyncUpResult = upSystemWorker(instance, inputs,
+                                                             _systemResults);
+                         });
+    return UP_SOON;
+}
+
+XRState::UpResult XRState::upSystemWorker(OpenXR::Instance *instance,
+                                          const SystemInputs &inputs,
+                                          SystemResults &results)
+{
+    OSGXR_TRACE_SCOPE("XRState::upSystemWorker");
 
     // Get OpenXR system for chosen form factor
 
-    switch (_settingsCopy.getFormFactor())
+    switch (inputs.formFactor)
     {
         case Settings::HEAD_MOUNTED_DISPLAY:
-            _formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+            results.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
             break;
         case Settings::HANDHELD_DISPLAY:
-            _formFactor = XR_FORM_FACTOR_HANDHELD_DISPLAY;
+            results.formFactor = XR_FORM_FACTOR_HANDHELD_DISPLAY;
             break;
     }
     bool supported;
-    _system = _instance->getSystem(_formFactor, &supported);
-    if (!_system)
+    OpenXR::System *system = instance->getSystem(results.formFactor, &supported);
+    if (!system)
         return supported ? UP_LATER : UP_ABORT;
 
+    // Reuse capabilities probed on a previous run of the same runtime
+    const std::string &probeCacheFile = inputs.probeCacheFile;
+    if (!probeCacheFile.empty())
+    {
+        if (results.probeCache.load(probeCacheFile, system))
+        {
+            results.probeCache.apply(system);
+        }
+        else
+        {
+            results.probeCache.record(system);
+            results.probeCacheDirty = true;
+        }
+    }
+
     // Choose the first supported view configuration
 
-    for (const auto &viewConfig: _system->getViewConfigurations())
+    const OpenXR::System::ViewConfiguration *chosenViewConfig = nullptr;
+    for (const auto &viewConfig: system->getViewConfigurations())
     {
         switch (viewConfig.getType())
         {
             case XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO:
             case XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO:
-                _chosenViewConfig = &viewConfig;
+                chosenViewConfig = &viewConfig;
                 break;
             default:
                 break;
         }
-        if (_chosenViewConfig)
+        if (chosenViewConfig)
             break;
     }
-    if (!_chosenViewConfig)
+    if (!chosenViewConfig)
     {
         OSG_WARN << "osgXR: No supported view configuration" << std::endl;
-        _system = nullptr;
         return UP_ABORT;
     }
 
     // Choose an environment blend mode
 
-    for (XrEnvironmentBlendMode envBlendMode: _chosenViewConfig->getEnvBlendModes())
+    XrEnvironmentBlendMode chosenEnvBlendMode = XR_ENVIRONMENT_BLEND_MODE_MAX_ENUM;
+    for (XrEnvironmentBlendMode envBlendMode: chosenViewConfig->getEnvBlendModes())
     {
         if ((unsigned int)envBlendMode > 31)
             continue;
         uint32_t mask = (1u << (unsigned int)envBlendMode);
-        if (_settingsCopy.getPreferredEnvBlendModeMask() & mask)
+        if (inputs.preferredEnvBlendModeMask & mask)
         {
-            _chosenEnvBlendMode = envBlendMode;
+            chosenEnvBlendMode = envBlendMode;
             break;
         }
-        if (_chosenEnvBlendMode != XR_ENVIRONMENT_BLEND_MODE_MAX_ENUM &&
-            _settingsCopy.getAllowedEnvBlendModeMask() & mask)
+        if (chosenEnvBlendMode != XR_ENVIRONMENT_BLEND_MODE_MAX_ENUM &&
+            inputs.allowedEnvBlendModeMask & mask)
         {
-            _chosenEnvBlendMode = envBlendMode;
+            chosenEnvBlendMode = envBlendMode;
         }
     }
-    if (_chosenEnvBlendMode == XR_ENVIRONMENT_BLEND_MODE_MAX_ENUM)
+    if (chosenEnvBlendMode == XR_ENVIRONMENT_BLEND_MODE_MAX_ENUM)
     {
         OSG_WARN << "osgXR: No supported environment blend mode" << std::endl;
-        _system = nullptr;
         return UP_ABORT;
     }
 
+    results.system = system;
+    results.chosenViewConfig = chosenViewConfig;
+    results.chosenEnvBlendMode = chosenEnvBlendMode;
     return UP_SUCCESS;
 }
 
 XRState::DownResult XRState::downSystem()
 {
+    OSGXR_TRACE_SCOPE("XRState::downSystem");
+    _probeCache.invalidate();
     _system = nullptr;
     _instance->invalidateSystem(_formFactor);
     return DOWN_SUCCESS;
@@ -1054,6 +1390,11 @@ XRState::DownResult XRState::downSystem()
 
 XRState::UpResult XRState::upSession()
 {
+    OSGXR_TRACE_SCOPE("XRState::upSession");
+    // Wait for the session to be created on the graphics thread
+    if (_asyncOperation.valid())
+        return finishAsyncOperation() ? finishUpSession() : UP_SOON;
+
     assert(_system);
     assert(!_session.valid());
 
@@ -1078,6 +1419,25 @@ XRState::UpResult XRState::upSession()
     _settingsCopy.setAlphaBits(_settings->getAlphaBits());
     _settingsCopy.setDepthBits(_settings->getDepthBits());
     _settingsCopy.setStencilBits(_settings->getStencilBits());
+    _settingsCopy.setFramesInFlight(_settings->getFramesInFlight());
+    _settingsCopy.setFramePacingThread(_settings->getFramePacingThread());
+    _settingsCopy.setLateLatching(_settings->getLateLatching(),
+                                  _settings->getLateLatchingCullMargin());
+    _settingsCopy.setGpuTiming(_settings->getGpuTiming());
+    _settingsCopy.setMirrorDecimation(_settings->getMirrorDecimation());
+    _settingsCopy.setDynamicResolution(_settings->getDynamicResolution(),
+                                       _settings->getDynamicResolutionMinScale(),
+                                       _settings->getDynamicResolutionMaxScale(),
+                                       _settings->getDynamicResolutionHysteresis());
+    _settingsCopy.setMultiViewCulling(_settings->getMultiViewCulling());
+    _settingsCopy.setSharedCulling(_settings->getSharedCulling());
+    _settingsCopy.setViewAlignmentMask(_settings->getViewAlignmentMask());
+
+    // Frames of a lost session may still be being drawn, so wait for them to
+    // leave the store before resizing it
+    if (!_frames.setMaxFrames(_settingsCopy.getFramesInFlight()))
+        return UP_SOON;
+
     _useDepthInfo = _settingsCopy.getDepthInfo();
     _useVisibilityMask = _settingsCopy.getVisibilityMask();
 
@@ -1091,20 +1451,62 @@ XRState::UpResult XRState::upSession()
         OSG_WARN << "osgXR: VisibilityMask extension not supported, visibility masking will be disabled" << std::endl;
         _useVisibilityMask = false;
     }
+    _useLateLatching = _settingsCopy.getLateLatching();
+    if (_useLateLatching &&
+        _vrMode != VRMode::VRMODE_GEOMETRY_SHADERS &&
+        _vrMode != VRMode::VRMODE_OVR_MULTIVIEW &&
+        _vrMode != VRMode::VRMODE_INSTANCED)
+    {
+        OSG_WARN << "osgXR: Late latching not supported in chosen VR mode, late latching will be disabled" << std::endl;
+        _useLateLatching = false;
+    }
+    if (_settingsCopy.getGpuTiming())
+        _gpuTimer = new GpuTimer();
+    _resolutionScale = 1.0f;
+    if (_settingsCopy.getDynamicResolution())
+        _dynamicResolution = new DynamicResolution(_settingsCopy.getDynamicResolutionMinScale(),
+                                                   _settingsCopy.getDynamicResolutionMaxScale(),
+                                                   _settingsCopy.getDynamicResolutionHysteresis());
 
-    // Stop threading to prevent the GL context being bound in another thread
-    // during certain OpenXR calls (session & swapchain handling).
-    if (_viewer.valid())
-        _viewer->stopThreading();
+    // Ensure composition layers are sorted
+    if (_compositionLayersUpdated)
+    {
+        _compositionLayersUpdated = false;
+        _compositionLayers.sort(CompositionLayer::Private::compareOrder);
+    }
+
+    // Session & swapchain creation is done on the graphics thread to prevent
+    // the GL context being bound in another thread during certain OpenXR
+    // calls, without having to stop the viewer's threads. It only works on
+    // _sessionGraphics, which is published once it completes.
+    _sessionGraphics.compositionLayers = _compositionLayers;
+    _sessionGraphics.useDepthInfo = _useDepthInfo;
+    if (!startGraphicsOperation("osgXR upSession", true,
+                                [this]() {
+                                    _asyncUpResult = upSessionGraphics(_sessionGraphics);
+                                }))
+        return UP_SOON;
+    return finishUpSession();
+}
+
+XRState::UpResult XRState::upSessionGraphics(SessionGraphics &graphics)
+{
+    OSGXR_TRACE_SCOPE("XRState::upSessionGraphics");
 
     // Create session using the GraphicsWindow
-    _session = new OpenXR::Session(_system, _window.get());
-    if (!_session->valid())
+    graphics.session = new OpenXR::Session(_system, _window.get());
+    OpenXR::Session *session = graphics.session.get();
+    if (!session->valid())
     {
-        _session = nullptr;
+        graphics.session = nullptr;
         return UP_ABORT;
     }
 
+    // Skip enumerating swapchain formats if they're already known
+    if (_probeCache.hasSwapchainFormats())
+        session->setSwapchainFormats(_probeCache.getSwapchainFormats());
+    const auto &swapchainFormats = session->getSwapchainFormats();
+
     // Decide on ideal bit depths
     unsigned int bestRGBBits = 24; // combined
     unsigned int bestAlphaBits = 0;
@@ -1134,7 +1536,8 @@ XRState::UpResult XRState::upSession()
     GLenum fallbackDepthFormat;
 
     // Choose OpenXR RGBA swapchain format
-    chosenRGBAFormat = chooseRGBAFormat(bestRGBBits,
+    chosenRGBAFormat = chooseRGBAFormat(swapchainFormats,
+                                        bestRGBBits,
                                         bestAlphaBits,
                                         _settingsCopy.getPreferredRGBEncodingMask(),
                                         _settingsCopy.getAllowedRGBEncodingMask());
@@ -1142,11 +1545,11 @@ XRState::UpResult XRState::upSession()
     {
         std::stringstream formats;
         formats << std::hex;
-        for (int64_t format: _session->getSwapchainFormats())
+        for (int64_t format: swapchainFormats)
             formats << " 0x" << format;
         OSG_WARN << "osgXR: No supported projection swapchain format found in ["
                  << formats.str() << " ]" << std::endl;
-        _session = nullptr;
+        graphics.session = nullptr;
         return UP_ABORT;
     }
 
@@ -1157,9 +1560,10 @@ XRState::UpResult XRState::upSession()
                                                     _settingsCopy.getAllowedDepthEncodingMask());
 
     // Choose OpenXR depth swapchain format
-    if (_useDepthInfo)
+    if (graphics.useDepthInfo)
     {
-        chosenDepthFormat = chooseDepthFormat(bestDepthBits,
+        chosenDepthFormat = chooseDepthFormat(swapchainFormats,
+                                              bestDepthBits,
                                               bestStencilBits,
                                               _settingsCopy.getPreferredDepthEncodingMask(),
                                               _settingsCopy.getAllowedDepthEncodingMask());
@@ -1167,11 +1571,11 @@ XRState::UpResult XRState::upSession()
         {
             std::stringstream formats;
             formats << std::hex;
-            for (int64_t format: _session->getSwapchainFormats())
+            for (int64_t format: swapchainFormats)
                 formats << " 0x" << format;
             OSG_WARN << "osgXR: No supported projection depth swapchain format found in ["
                 << formats.str() << " ]" << std::endl;
-            _useDepthInfo = false;
+            graphics.useDepthInfo = false;
         }
     }
 
@@ -1179,21 +1583,23 @@ XRState::UpResult XRState::upSession()
     switch (_swapchainMode)
     {
         case SwapchainMode::SWAPCHAIN_SINGLE:
-            if (!setupSingleSwapchain(chosenRGBAFormat,
+            if (!setupSingleSwapchain(graphics,
+                                      chosenRGBAFormat,
                                       chosenDepthFormat,
                                       fallbackDepthFormat))
             {
-                dropSessionCheck();
+                dropSessionCheck(graphics.session);
                 return UP_ABORT;
             }
             break;
 
         case SwapchainMode::SWAPCHAIN_LAYERED:
-            if (!setupLayeredSwapchain(chosenRGBAFormat,
+            if (!setupLayeredSwapchain(graphics,
+                                       chosenRGBAFormat,
                                        chosenDepthFormat,
                                        fallbackDepthFormat))
             {
-                dropSessionCheck();
+                dropSessionCheck(graphics.session);
                 return UP_ABORT;
             }
             break;
@@ -1201,43 +1607,93 @@ XRState::UpResult XRState::upSession()
         case SwapchainMode::SWAPCHAIN_AUTOMATIC:
             // Should already have been handled by upSession()
         case SwapchainMode::SWAPCHAIN_MULTIPLE:
-            if (!setupMultipleSwapchains(chosenRGBAFormat,
+            if (!setupMultipleSwapchains(graphics,
+                                         chosenRGBAFormat,
                                          chosenDepthFormat,
                                          fallbackDepthFormat))
             {
-                dropSessionCheck();
+                dropSessionCheck(graphics.session);
                 return UP_ABORT;
             }
             break;
     }
 
     // Finally set up other composition layers
-    // Ensure layers are sorted
-    if (_compositionLayersUpdated)
-    {
-        _compositionLayersUpdated = false;
-        _compositionLayers.sort(CompositionLayer::Private::compareOrder);
+    for (auto *layer: graphics.compositionLayers)
+        layer->setup(session);
+    graphics.compositionLayers.clear();
+
+    return UP_SUCCESS;
+}
+
+XRState::UpResult XRState::finishUpSession()
+{
+    // Publish what the graphics thread set up
+    _session = _sessionGraphics.session;
+    _sessionGraphics.session = nullptr;
+    _xrViews.swap(_sessionGraphics.xrViews);
+    _sessionGraphics.xrViews.clear();
+    _sessionGraphics.compositionLayers.clear();
+    _useDepthInfo = _sessionGraphics.useDepthInfo;
+    if (_asyncUpResult != UP_SUCCESS)
+        return _asyncUpResult;
+
+    // Report how long startup took, e.g. to compare with the probe cache
+    const char *cacheUse = "";
+    if (_probeCache.valid())
+        cacheUse = _probeCache.hasSwapchainFormats() ? " (probe cache hit)"
+                                                     : " (probe cache miss)";
+    OSG_INFO << "osgXR: Session created "
+             << osg::Timer::instance()->delta_m(_startupTick,
+                                                osg::Timer::instance()->tick())
+             << " ms after starting to create the instance" << cacheUse
+             << std::endl;
+
+    // Update the probe cache now everything has been enumerated
+    if (_probeCache.valid() && !_probeCache.hasSwapchainFormats())
+    {
+        _probeCache.setSwapchainFormats(_session->getSwapchainFormats());
+        _probeCacheDirty = true;
+    }
+    if (_probeCacheDirty && _worker.valid())
+    {
+        // Write a copy to disk from the worker thread so as not to stall the
+        // update thread on file I/O
+        OpenXR::ProbeCache probeCache = _probeCache;
+        std::string probeCacheFile = _settingsCopy.getProbeCacheFile();
+        _worker->add(new XRAsyncOperation("osgXR probe cache save",
+                                          [probeCache, probeCacheFile]() {
+                                              probeCache.save(probeCacheFile);
+                                          }));
+        _probeCacheDirty = false;
     }
-    // Set up all layers
-    for (auto *layer: _compositionLayers)
-        layer->setup(_session);
 
     return UP_SUCCESS;
 }
 
 XRState::DownResult XRState::downSession()
 {
+    OSGXR_TRACE_SCOPE("XRState::downSession");
+    // Wait for the session to be destroyed on the graphics thread
+    if (_asyncOperation.valid())
+        return finishAsyncOperation() ? DOWN_SUCCESS : DOWN_SOON;
+
     assert(_session.valid());
 
     if (_session->isLost())
     {
-        XrSessionState curState = _session->getState();
-        if (curState == XR_SESSION_STATE_FOCUSED)
-            onSessionStateUnfocus(_session);
-        if (_session->isRunning())
-            onSessionStateStopping(_session, true);
-        // Attempt restart
-        onSessionStateEnd(_session, true);
+        if (!_stoppingSession)
+        {
+            XrSessionState curState = _session->getState();
+            if (curState == XR_SESSION_STATE_FOCUSED)
+                onSessionStateUnfocus(_session);
+            if (_session->isRunning())
+                onSessionStateStopping(_session, true);
+            // Attempt restart
+            onSessionStateEnd(_session, true);
+        }
+        if (!finishStoppingSession())
+            return DOWN_SOON;
     }
     else if (_session->isRunning())
     {
@@ -1249,23 +1705,7 @@ XRState::DownResult XRState::downSession()
     // no frames should be in progress
     assert(!_frames.countFrames());
 
-    // Stop threading to prevent the GL context being bound in another thread
-    // during certain OpenXR calls (session & swapchain destruction).
-    if (_viewer.valid())
-        _viewer->stopThreading();
-
-    // Ensure the GL context is active for destruction of FBOs in XRFramebuffer
-    if (_wasThreading)
-        _window->makeCurrent();
-    _xrViews.resize(0);
-    if (_wasThreading)
-        _window->releaseContext();
-
-    // Clean compilation layers
-    for (auto *layer: _compositionLayers)
-        layer->cleanupSession();
-
-    // this will destroy the session
+    // Clean up users of the session which don't need the GL context
     for (auto *actionSet: _actionSets)
         actionSet->cleanupSession();
     for (auto &pair: _subactions)
@@ -1276,13 +1716,57 @@ XRState::DownResult XRState::downSession()
     }
     for (auto *space: _spaces)
         space->cleanupSession();
-    dropSessionCheck();
-
+    _session->releaseFramePool();
+
+    // Swapchain & session destruction is done on the graphics thread to
+    // prevent the GL context being bound in another thread during certain
+    // OpenXR calls, and so that FBOs in XRFramebuffer can be destroyed. The
+    // session is handed over here so update and cull stop using it, but the
+    // objects used by draw callbacks are only taken once any previous frame
+    // has finished drawing, by the graphics operation itself.
+    _sessionGraphics.session.swap(_session);
+    _sessionGraphics.compositionLayers = _compositionLayers;
+    if (!startGraphicsOperation("osgXR downSession", false,
+                                [this]() {
+                                    takeSessionGraphics(_sessionGraphics);
+                                    downSessionGraphics(_sessionGraphics);
+                                }))
+        return DOWN_SOON;
     return DOWN_SUCCESS;
 }
 
+void XRState::takeSessionGraphics(SessionGraphics &graphics)
+{
+    graphics.xrViews.swap(_xrViews);
+    graphics.gpuTimer.swap(_gpuTimer);
+    _projectionLayer = nullptr;
+    _projectionLayerPool.clear();
+    _dynamicResolution = nullptr;
+}
+
+void XRState::downSessionGraphics(SessionGraphics &graphics)
+{
+    OSGXR_TRACE_SCOPE("XRState::downSessionGraphics");
+
+    graphics.xrViews.clear();
+    if (graphics.gpuTimer.valid())
+    {
+        graphics.gpuTimer->releaseGLObjects(_window->getState());
+        graphics.gpuTimer = nullptr;
+    }
+
+    // Clean compilation layers
+    for (auto *layer: graphics.compositionLayers)
+        layer->cleanupSession();
+    graphics.compositionLayers.clear();
+
+    // this will destroy the session
+    dropSessionCheck(graphics.session);
+}
+
 XRState::UpResult XRState::upActions()
 {
+    OSGXR_TRACE_SCOPE("XRState::upActions");
     // Wait until the app has set up action sets and interaction profiles
     if (_actionSets.empty() || _interactionProfiles.empty())
         return UP_SOON;
@@ -1302,14 +1786,15 @@ XRState::UpResult XRState::upActions()
 
 XRState::DownResult XRState::downActions()
 {
+    OSGXR_TRACE_SCOPE("XRState::downActions");
     // Action setup cannot be undone
     return DOWN_SUCCESS;
 }
 
-bool XRState::dropSessionCheck()
+bool XRState::dropSessionCheck(osg::ref_ptr<OpenXR::Session> &session)
 {
-    osg::observer_ptr<OpenXR::Session> oldSession = _session;
-    _session = nullptr;
+    osg::observer_ptr<OpenXR::Session> oldSession = session;
+    session = nullptr;
     if (oldSession.valid()) {
         OSG_WARN << "osgXR: Session not cleaned up" << std::endl;
         return false;
@@ -1361,6 +1846,18 @@ bool XRState::validateMode(VRMode vrMode, SwapchainMode swapchainMode,
         if (!osg::isGLExtensionSupported(contextID, "GL_ARB_shader_viewport_layer_array"))
             outErrors.push_back("OpenGL: GL_ARB_shader_viewport_layer_array required");
     }
+    else if (vrMode == Settings::VRMODE_INSTANCED)
+    {
+        if (!osg::isGLExtensionOrVersionSupported(contextID, "GL_ARB_draw_instanced", 3.1f))
+            outErrors.push_back("OpenGL: GL_ARB_draw_instanced required");
+        if (!osg::isGLExtensionSupported(contextID, "GL_ARB_viewport_array"))
+            outErrors.push_back("OpenGL: GL_ARB_viewport_array required");
+        if (!osg::isGLExtensionSupported(contextID, "GL_ARB_shader_viewport_layer_array"))
+            outErrors.push_back("OpenGL: GL_ARB_shader_viewport_layer_array required");
+        if (swapchainMode == Settings::SWAPCHAIN_LAYERED &&
+            !XRFramebuffer::supportsGeomLayer(*state))
+            outErrors.push_back("OpenGL: glFramebufferTexture required");
+    }
 
     return outErrors.empty();
 }
@@ -1378,8 +1875,8 @@ struct ModePriority
         PRIORITY_SWAPCHAIN_SHIFT = 0,
         PRIORITY_SWAPCHAIN_MASK  = 0x3,
         PRIORITY_VRMODE_SHIFT    = PRIORITY_SWAPCHAIN_SHIFT + 2,
-        PRIORITY_VRMODE_MASK     = 0x3,
-        PRIORITY_PREF_SHIFT      = PRIORITY_VRMODE_SHIFT + 2,
+        PRIORITY_VRMODE_MASK     = 0x7,
+        PRIORITY_PREF_SHIFT      = PRIORITY_VRMODE_SHIFT + 3,
         PRIORITY_PREF_MASK       = 0x3,
     };
     // Priority order, high to low
@@ -1389,8 +1886,9 @@ struct ModePriority
         PREF_NONE = 2,
     } Preference;
     // Priority order, high to low
-    static constexpr Settings::VRMode vrMapping[4] = {
+    static constexpr Settings::VRMode vrMapping[5] = {
         Settings::VRMODE_OVR_MULTIVIEW,
+        Settings::VRMODE_INSTANCED,
         Settings::VRMODE_GEOMETRY_SHADERS,
         Settings::VRMODE_SCENE_VIEW,
         Settings::VRMODE_SLAVE_CAMERAS,
@@ -1415,7 +1913,7 @@ struct ModePriority
 
     void setVRMode(Settings::VRMode mode)
     {
-        for (unsigned int i = 0; i <= PRIORITY_VRMODE_MASK; ++i) {
+        for (unsigned int i = 0; i < sizeof(vrMapping) / sizeof(vrMapping[0]); ++i) {
             if (vrMapping[i] == mode) {
                 priority &= ~(PRIORITY_VRMODE_MASK << PRIORITY_VRMODE_SHIFT);
                 priority |= i << PRIORITY_VRMODE_SHIFT;
@@ -1468,6 +1966,7 @@ struct ModePriority
         case Settings::VRMODE_SCENE_VIEW:       vrmodeName = "osg";   break;
         case Settings::VRMODE_GEOMETRY_SHADERS: vrmodeName = "geom";  break;
         case Settings::VRMODE_OVR_MULTIVIEW:    vrmodeName = "ovr";   break;
+        case Settings::VRMODE_INSTANCED:        vrmodeName = "inst";  break;
         default:                                vrmodeName = "UNK";   break;
         }
         const char * swapchainName = nullptr;
@@ -1525,6 +2024,8 @@ void XRState::chooseMode(VRMode *outVRMode,
         ModePriority(Settings::VRMODE_GEOMETRY_SHADERS, Settings::SWAPCHAIN_LAYERED),
         ModePriority(Settings::VRMODE_GEOMETRY_SHADERS, Settings::SWAPCHAIN_SINGLE),
         ModePriority(Settings::VRMODE_OVR_MULTIVIEW, Settings::SWAPCHAIN_LAYERED),
+        ModePriority(Settings::VRMODE_INSTANCED, Settings::SWAPCHAIN_LAYERED),
+        ModePriority(Settings::VRMODE_INSTANCED, Settings::SWAPCHAIN_SINGLE),
     };
     for (ModePriority mode : modesValid)
     {
@@ -1607,7 +2108,8 @@ static void applyDefaultDepthEncoding(uint32_t &preferredDepthEncodingMask,
     }
 }
 
-int64_t XRState::chooseRGBAFormat(unsigned int bestRGBBits,
+int64_t XRState::chooseRGBAFormat(const OpenXR::Session::SwapchainFormats &formats,
+                                  unsigned int bestRGBBits,
                                   unsigned int bestAlphaBits,
                                   uint32_t preferredRGBEncodingMask,
                                   uint32_t allowedRGBEncodingMask) const
@@ -1619,7 +2121,7 @@ int64_t XRState::chooseRGBAFormat(unsigned int bestRGBBits,
     int64_t chosenRGBAFormat = 0;
     unsigned int chosenAlphaBits = 0;
     uint32_t chosenRGBSat = 0;
-    for (int64_t format: _session->getSwapchainFormats())
+    for (int64_t format: formats)
     {
         auto thisEncoding = Settings::ENCODING_LINEAR;
         uint32_t encodingMask = 0;
@@ -1729,7 +2231,8 @@ GLenum XRState::chooseFallbackDepthFormat(unsigned int bestDepthBits,
     }
 }
 
-int64_t XRState::chooseDepthFormat(unsigned int bestDepthBits,
+int64_t XRState::chooseDepthFormat(const OpenXR::Session::SwapchainFormats &formats,
+                                   unsigned int bestDepthBits,
                                    unsigned int bestStencilBits,
                                    uint32_t preferredDepthEncodingMask,
                                    uint32_t allowedDepthEncodingMask) const
@@ -1742,7 +2245,7 @@ int64_t XRState::chooseDepthFormat(unsigned int bestDepthBits,
     unsigned int chosenDepthBits = 0;
     unsigned int chosenStencilBits = 0;
     uint32_t chosenDepthSat = 0;
-    for (int64_t format: _session->getSwapchainFormats())
+    for (int64_t format: formats)
     {
         auto thisEncoding = Settings::ENCODING_LINEAR;
         uint32_t encodingMask = 0;
@@ -1825,7 +2328,8 @@ int64_t XRState::chooseDepthFormat(unsigned int bestDepthBits,
     return chosenDepthFormat;
 }
 
-bool XRState::setupSingleSwapchain(int64_t format, int64_t depthFormat,
+bool XRState::setupSingleSwapchain(SessionGraphics &graphics,
+                                   int64_t format, int64_t depthFormat,
                                    GLenum fallbackDepthFormat)
 {
     const auto &views = _chosenViewConfig->getViews();
@@ -1836,12 +2340,12 @@ bool XRState::setupSingleSwapchain(int64_t format, int64_t depthFormat,
     viewports.resize(views.size());
     for (uint32_t i = 0; i < views.size(); ++i) {
         OpenXR::System::ViewConfiguration::View view = views[i];
-        view.alignSize(_settings->getViewAlignmentMask());
+        view.alignSize(_settingsCopy.getViewAlignmentMask());
         viewports[i] = singleView.tileHorizontally(view);
     }
 
     // Create a single swapchain
-    osg::ref_ptr<XRSwapchain> xrSwapchain = new XRSwapchain(this, _session,
+    osg::ref_ptr<XRSwapchain> xrSwapchain = new XRSwapchain(this, graphics.session,
                                                             singleView, format,
                                                             depthFormat,
                                                             fallbackDepthFormat);
@@ -1851,27 +2355,28 @@ bool XRState::setupSingleSwapchain(int64_t format, int64_t depthFormat,
     }
 
     // And the views
-    _xrViews.reserve(views.size());
+    graphics.xrViews.reserve(views.size());
     for (uint32_t i = 0; i < views.size(); ++i)
     {
         osg::ref_ptr<XRView> xrView = new XRView(this, i, xrSwapchain,
                                                  viewports[i]);
         if (!xrView.valid())
         {
-            _xrViews.resize(0);
+            graphics.xrViews.resize(0);
             return false; // failure
         }
-        _xrViews.push_back(xrView);
+        graphics.xrViews.push_back(xrView);
     }
 
     return true;
 }
 
-bool XRState::setupLayeredSwapchain(int64_t format, int64_t depthFormat,
+bool XRState::setupLayeredSwapchain(SessionGraphics &graphics,
+                                    int64_t format, int64_t depthFormat,
                                     GLenum fallbackDepthFormat)
 {
     const auto &views = _chosenViewConfig->getViews();
-    _xrViews.reserve(views.size());
+    graphics.xrViews.reserve(views.size());
 
     // Arrange viewports on a single layered swapchain image
     OpenXR::System::ViewConfiguration::View layeredView;
@@ -1879,15 +2384,16 @@ bool XRState::setupLayeredSwapchain(int64_t format, int64_t depthFormat,
     viewports.resize(views.size());
     for (uint32_t i = 0; i < views.size(); ++i) {
         OpenXR::System::ViewConfiguration::View view = views[i];
-        view.alignSize(_settings->getViewAlignmentMask());
+        view.alignSize(_settingsCopy.getViewAlignmentMask());
         viewports[i] = layeredView.tileLayered(view);
     }
 
     // Create a single swapchain
     unsigned int fbPerLayer = 0; // An FBO per layer per swapchain image
-    if (_vrMode == VRMode::VRMODE_GEOMETRY_SHADERS)
+    if (_vrMode == VRMode::VRMODE_GEOMETRY_SHADERS ||
+        _vrMode == VRMode::VRMODE_INSTANCED)
     {
-        // Single FBO per swapchain image, gl_Layer specified by geom shader
+        // Single FBO per swapchain image, gl_Layer specified by shaders
         fbPerLayer = XRFramebuffer::ARRAY_INDEX_GEOMETRY;
     }
     else if (_vrMode == VRMode::VRMODE_OVR_MULTIVIEW)
@@ -1895,7 +2401,7 @@ bool XRState::setupLayeredSwapchain(int64_t format, int64_t depthFormat,
         // Single FBO per swapchain image, gl_ViewID_OVR determines layer
         fbPerLayer = XRFramebuffer::ARRAY_INDEX_MULTIVIEW;
     }
-    osg::ref_ptr<XRSwapchain> xrSwapchain = new XRSwapchain(this, _session,
+    osg::ref_ptr<XRSwapchain> xrSwapchain = new XRSwapchain(this, graphics.session,
                                                             layeredView, format,
                                                             depthFormat,
                                                             fallbackDepthFormat,
@@ -1906,47 +2412,48 @@ bool XRState::setupLayeredSwapchain(int64_t format, int64_t depthFormat,
     }
 
     // And the views
-    _xrViews.reserve(views.size());
+    graphics.xrViews.reserve(views.size());
     for (uint32_t i = 0; i < views.size(); ++i)
     {
         osg::ref_ptr<XRView> xrView = new XRView(this, i, xrSwapchain,
                                                  viewports[i]);
         if (!xrView.valid())
         {
-            _xrViews.resize(0);
+            graphics.xrViews.resize(0);
             return false; // failure
         }
-        _xrViews.push_back(xrView);
+        graphics.xrViews.push_back(xrView);
     }
 
     return true;
 }
 
-bool XRState::setupMultipleSwapchains(int64_t format, int64_t depthFormat,
+bool XRState::setupMultipleSwapchains(SessionGraphics &graphics,
+                                      int64_t format, int64_t depthFormat,
                                       GLenum fallbackDepthFormat)
 {
     const auto &views = _chosenViewConfig->getViews();
-    _xrViews.reserve(views.size());
+    graphics.xrViews.reserve(views.size());
 
     for (uint32_t i = 0; i < views.size(); ++i)
     {
         const auto &vcView = views[i];
-        osg::ref_ptr<XRSwapchain> xrSwapchain = new XRSwapchain(this, _session,
+        osg::ref_ptr<XRSwapchain> xrSwapchain = new XRSwapchain(this, graphics.session,
                                                                 vcView, format,
                                                                 depthFormat,
                                                                 fallbackDepthFormat);
         if (!xrSwapchain->valid()) {
             OSG_WARN << "osgXR: Invalid swapchain for view " << i << std::endl;
-            _xrViews.resize(0);
+            graphics.xrViews.resize(0);
             return false; // failure
         }
         osg::ref_ptr<XRView> xrView = new XRView(this, i, xrSwapchain);
         if (!xrView.valid())
         {
-            _xrViews.resize(0);
+            graphics.xrViews.resize(0);
             return false; // failure
         }
-        _xrViews.push_back(xrView);
+        graphics.xrViews.push_back(xrView);
     }
 
     return true;
@@ -1972,6 +2479,10 @@ void XRState::setupSlaveCameras()
     osg::Camera *camera = _view.valid() ? _view->getCamera() : nullptr;
     //camera->setName("Main");
 
+    // Let the scene cameras share a cull traversal
+    if (_settingsCopy.getSharedCulling() && _xrViews.size() > 1)
+        _sharedCull = new SharedCull(_session.get(), _xrViews.size());
+
     _appViews.resize(_xrViews.size());
     for (uint32_t i = 0; i < _xrViews.size(); ++i)
     {
@@ -2086,6 +2597,23 @@ void XRState::setupOVRMultiviewCameras()
     _appViews[0] = appView;
 }
 
+void XRState::setupInstancedCameras()
+{
+    // Put all XR views in a single instanced AppView
+    std::vector<uint32_t> viewIndices;
+    viewIndices.reserve(_xrViews.size());
+    for (uint32_t viewIndex = 0; viewIndex < _xrViews.size(); ++viewIndex)
+        viewIndices.push_back(viewIndex);
+
+    AppViewInstanced *appView = new AppViewInstanced(this, viewIndices,
+                                                     _window.get(),
+                                                     _view.get());
+    appView->init();
+
+    _appViews.resize(1);
+    _appViews[0] = appView;
+}
+
 void XRState::setupSceneViewVisibilityMasks(osg::Camera *camera,
                                             osg::ref_ptr<osg::MatrixTransform> &transform)
 {
@@ -2165,34 +2693,243 @@ osg::ref_ptr<osg::Geode> XRState::setupVisibilityMask(osg::Camera *camera, uint3
     return geode;
 }
 
-osg::ref_ptr<OpenXR::Session::Frame> XRState::getFrame(osg::FrameStamp *stamp)
+void XRState::setupMultiViewVisibilityMasks(osg::Camera *camera,
+                                            const std::vector<uint32_t> &viewIndices,
+                                            VisibilityMaskRouting routing,
+                                            osg::Uniform *projections,
+                                            osg::ref_ptr<osg::MatrixTransform> &transform)
+{
+    // Vertices are tangents at unit distance in front of each view. They're
+    // projected with that view's projection and pinned to the near plane so
+    // they're never depth clipped, and the depth range forces them to 0.
+    std::string strViews = std::to_string(viewIndices.size());
+    std::string vertSrc, geomSrc;
+    if (routing == VIS_MASK_ROUTE_OVR_MULTIVIEW)
+    {
+        // Every draw is broadcast to all views, so push the triangles out of
+        // the clip volume in views other than their own
+        vertSrc =
+            "#version 330\n"
+            "#extension GL_OVR_multiview2 : require\n"
+            "#extension GL_ARB_shader_viewport_layer_array : enable\n"
+            "layout (num_views = " + strViews + ") in;\n"
+            "uniform mat4 osgxr_visibility_mask_projections[" + strViews + "];\n"
+            "uniform int osgxr_visibility_mask_view;\n"
+            "void main()\n"
+            "{\n"
+            "    int view = int(gl_ViewID_OVR);\n"
+            "    gl_ViewportIndex = view;\n"
+            "    if (view != osgxr_visibility_mask_view) {\n"
+            "        gl_Position = vec4(2.0, 2.0, 0.0, 1.0);\n"
+            "        return;\n"
+            "    }\n"
+            "    vec4 pos = osgxr_visibility_mask_projections[view] * vec4(gl_Vertex.xy, -1.0, 1.0);\n"
+            "    gl_Position = vec4(pos.xy, 0.0, pos.w);\n"
+            "}\n";
+    }
+    else if (routing == VIS_MASK_ROUTE_INSTANCED)
+    {
+        // The masks are drawn with an instance per view like everything else,
+        // so push the triangles out of the clip volume in other views
+        std::string strRoute = "    gl_ViewportIndex = view;\n";
+        if (getSwapchainMode() == Settings::SwapchainMode::SWAPCHAIN_LAYERED)
+            strRoute += "    gl_Layer = view;\n";
+        vertSrc =
+            "#version 330\n"
+            "#extension GL_ARB_shader_viewport_layer_array : enable\n"
+            "uniform mat4 osgxr_visibility_mask_projections[" + strViews + "];\n"
+            "uniform int osgxr_visibility_mask_view;\n"
+            "void main()\n"
+            "{\n"
+            "    int view = gl_InstanceID % " + strViews + ";\n"
+            + strRoute +
+            "    if (view != osgxr_visibility_mask_view) {\n"
+            "        gl_Position = vec4(2.0, 2.0, 0.0, 1.0);\n"
+            "        return;\n"
+            "    }\n"
+            "    vec4 pos = osgxr_visibility_mask_projections[view] * vec4(gl_Vertex.xy, -1.0, 1.0);\n"
+            "    gl_Position = vec4(pos.xy, 0.0, pos.w);\n"
+            "}\n";
+    }
+    else
+    {
+        vertSrc =
+            "#version 330\n"
+            "uniform mat4 osgxr_visibility_mask_projections[" + strViews + "];\n"
+            "uniform int osgxr_visibility_mask_view;\n"
+            "void main()\n"
+            "{\n"
+            "    vec4 pos = osgxr_visibility_mask_projections[osgxr_visibility_mask_view] * vec4(gl_Vertex.xy, -1.0, 1.0);\n"
+            "    gl_Position = vec4(pos.xy, 0.0, pos.w);\n"
+            "}\n";
+        std::string strRoute = "        gl_ViewportIndex = osgxr_visibility_mask_view;\n";
+        if (getSwapchainMode() == Settings::SwapchainMode::SWAPCHAIN_LAYERED)
+            strRoute += "        gl_Layer = osgxr_visibility_mask_view;\n";
+        geomSrc =
+            "#version 330\n"
+            "#extension GL_ARB_viewport_array : enable\n"
+            "layout (triangles) in;\n"
+            "layout (triangle_strip, max_vertices = 3) out;\n"
+            "uniform int osgxr_visibility_mask_view;\n"
+            "void main()\n"
+            "{\n"
+            "    for (int i = 0; i < 3; ++i) {\n"
+            "        gl_Position = gl_in[i].gl_Position;\n"
+            + strRoute +
+            "        EmitVertex();\n"
+            "    }\n"
+            "    EndPrimitive();\n"
+            "}\n";
+    }
+    const char* fragSrc =
+        "#version 330\n"
+        "void main()\n"
+        "{\n"
+        "}\n";
+
+    osg::ref_ptr<osg::Program> program = new osg::Program();
+    program->addShader(new osg::Shader(osg::Shader::VERTEX, vertSrc));
+    if (!geomSrc.empty())
+        program->addShader(new osg::Shader(osg::Shader::GEOMETRY, geomSrc));
+    program->addShader(new osg::Shader(osg::Shader::FRAGMENT, fragSrc));
+    program->setName("osgXR VisibilityMask multiview");
+
+    for (uint32_t i = 0; i < viewIndices.size(); ++i)
+    {
+        osg::ref_ptr<osg::Geode> geode = setupVisibilityMask(camera,
+                                                             viewIndices[i],
+                                                             transform);
+        if (geode.valid())
+        {
+            osg::StateSet *state = geode->getStateSet();
+            state->setAttribute(program);
+            state->addUniform(new osg::Uniform("osgxr_visibility_mask_view",
+                                               (int)i));
+        }
+    }
+    if (transform.valid())
+        transform->getOrCreateStateSet()->addUniform(projections);
+}
+
+OpenXR::Session::Frame *XRState::getFrame(osg::FrameStamp *stamp)
 {
     // Fast path
-    osg::ref_ptr<OpenXR::Session::Frame> frame = _frames.getFrame(stamp);
-    if (frame.valid())
+    OpenXR::Session::Frame *frame = _frames.getFrame(stamp);
+    if (frame)
         return frame;
 
-    if (!_session->isRunning())
+    if (!_session.valid() || !_session->isRunning())
         return nullptr;
 
     // Slow path
     return _frames.getFrame(stamp, _session);
 }
 
+void XRState::updateFrame()
+{
+    OSGXR_TRACE_SCOPE("XRState::updateFrame");
+    // Wait for the frame here rather than in whichever camera asks first, as
+    // the viewer and resolution scale may only be changed from this thread
+    // Don't wait for more frames while the session is stopping
+    osg::ref_ptr<osgViewer::View> view;
+    if (_stoppingSession || !_view.lock(view))
+        return;
+    OpenXR::Session::Frame *frame = getFrame(view->getFrameStamp());
+    if (frame)
+    {
+        setIdle(!frame->shouldRender());
+        if (_dynamicResolution.valid())
+            applyResolutionScale(frame);
+    }
+}
+
+void XRState::setIdle(bool idle)
+{
+    // Cameras skip idle frames themselves, see shouldRender()
+    if (idle == _idle)
+        return;
+    _idle = idle;
+
+    // Optionally throttle the viewer while there's nothing to display
+    if (!_viewer.valid())
+        return;
+    double idleFrameRate = _settings->getIdleFrameRate();
+    if (idle && idleFrameRate > 0.0)
+    {
+        _savedMaxFrameRate = _viewer->getRunMaxFrameRate();
+        _viewer->setRunMaxFrameRate(idleFrameRate);
+        _idleFrameRateLimited = true;
+    }
+    else if (!idle && _idleFrameRateLimited)
+    {
+        _viewer->setRunMaxFrameRate(_savedMaxFrameRate);
+        _idleFrameRateLimited = false;
+    }
+}
+
+void XRState::applyResolutionScale(OpenXR::Session::Frame *frame)
+{
+    // Choose the scale once per frame, when it is first waited for, so the
+    // whole frame is rendered and submitted at the same scale. The cameras
+    // are only rescaled when the frame is drawn, as the previous frame may
+    // still be drawing.
+    _resolutionScale = _dynamicResolution->getScale();
+    frame->setRenderScale(_resolutionScale);
+}
+
 void XRState::startRendering(osg::FrameStamp *stamp)
 {
-    osg::ref_ptr<OpenXR::Session::Frame> frame = getFrame(stamp);
-    if (frame.valid() && !frame->hasBegun())
+    OpenXR::Session::Frame *frame = getFrame(stamp);
+    if (frame && _frames.beginFrame(stamp))
     {
-        frame->begin();
-        _projectionLayer = new OpenXR::CompositionLayerProjection(_xrViews.size());
+        _renderStartTick = osg::Timer::instance()->tick();
+        for (auto &duration: _drawTimings.durations)
+            duration = 0.0;
+        // Recycle a projection layer which has been submitted if possible
+        _projectionLayer = _projectionLayerPool.getUnused();
+        if (_projectionLayer.valid())
+        {
+            _projectionLayer->reset(_xrViews.size());
+        }
+        else
+        {
+            _projectionLayer = new OpenXR::CompositionLayerProjection(_xrViews.size());
+            _projectionLayerPool.add(_projectionLayer.get());
+        }
         _projectionLayer->setLayerFlags(XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT);
         _projectionLayer->setSpace(frame->getLocalSpace());
+
+        // Write per-view uniforms for the frame before the first draw pass,
+        // late latching fresher view locations if possible
+        bool lateLatch = (_useLateLatching && frame->shouldRender() &&
+                          frame->lateLatchViews());
+        bool latched = lateLatch && !_appViews.empty();
+        for (auto &appView: _appViews)
+            if (!appView->applyViewUniforms(frame, lateLatch))
+                latched = false;
+        // Submit the views which were actually rendered
+        if (lateLatch && !latched)
+            frame->discardLateLatchedViews();
     }
 }
 
-void XRState::endFrame(osg::FrameStamp *stamp)
+void XRState::endFrameBeforeMirror(const osg::FrameStamp *stamp)
 {
+    if (_endedFrameNumber == stamp->getFrameNumber())
+        return;
+    OpenXR::Session::Frame *frame = _frames.getFrame(stamp);
+    if (!frame || !frame->hasBegun() || !frame->shouldRender())
+        return;
+    // Mirrors drawn before the views leave it to the swap
+    for (auto &view: _xrViews)
+        if (!view->getSwapchain()->isDrawn(stamp))
+            return;
+    endFrame(stamp);
+}
+
+void XRState::endFrame(const osg::FrameStamp *stamp)
+{
+    // Keep the frame to record its timings once it has been ended
     osg::ref_ptr<OpenXR::Session::Frame> frame = _frames.getFrame(stamp);
     if (!frame.valid())
     {
@@ -2202,24 +2939,54 @@ void XRState::endFrame(osg::FrameStamp *stamp)
     if (!frame->hasBegun())
     {
         OSG_WARN << "osgXR: OpenXR frame not begun" << std::endl;
-        _frames.killFrame(stamp);
+        // A waited frame still needs beginning and ending so that the runtime
+        // doesn't block the next xrWaitFrame, so submit it with no layers.
+        frame->setEnvBlendMode(_chosenEnvBlendMode);
+        _frames.discardFrame(stamp);
         return;
     }
-    for (auto &view: _xrViews)
-        view->endFrame(frame);
     frame->setEnvBlendMode(_chosenEnvBlendMode);
-    for (auto *layer: _compositionLayers)
+    // If the runtime won't display the frame nothing was rendered, so submit
+    // it with no layers
+    if (frame->shouldRender())
     {
-        if (layer->getOrder() >= 0)
-            break;
-        if (layer->getVisible())
-            layer->endFrame(frame);
+        for (auto &view: _xrViews)
+            view->endFrame(frame);
+        for (auto *layer: _compositionLayers)
+        {
+            if (layer->getOrder() >= 0)
+                break;
+            if (layer->getVisible())
+                layer->endFrame(frame);
+        }
+        frame->addLayer(_projectionLayer.get());
+        for (auto *layer: _compositionLayers)
+            if (layer->getOrder() >= 0 && layer->getVisible())
+                layer->endFrame(frame);
+
+        // Adapt resolution to the time taken to render, before waiting on
+        // the compositor in xrEndFrame
+        if (_dynamicResolution.valid())
+        {
+            double renderTime = osg::Timer::instance()->delta_s(_renderStartTick,
+                                                                osg::Timer::instance()->tick());
+            if (_gpuTimer.valid())
+                renderTime = std::max(renderTime, _gpuTimer->getFrameDuration());
+            _dynamicResolution->update(renderTime, frame->getPeriod() * 1e-9);
+        }
     }
-    frame->addLayer(_projectionLayer.get());
-    for (auto *layer: _compositionLayers)
-        if (layer->getOrder() >= 0 && layer->getVisible())
-            layer->endFrame(frame);
     _frames.endFrame(stamp);
+    _endedFrameNumber = stamp->getFrameNumber();
+
+    // Record frame timings
+    FrameTimer::Record record = _drawTimings;
+    record.durations[FrameTimings::PHASE_WAIT_FRAME] = frame->getWaitDuration();
+    record.durations[FrameTimings::PHASE_BEGIN_FRAME] = frame->getBeginDuration();
+    record.durations[FrameTimings::PHASE_END_FRAME] = frame->getEndDuration();
+    record.predictedDisplayTime = frame->getTime();
+    record.predictedDisplayPeriod = frame->getPeriod();
+    record.resolutionScale = frame->getRenderScale();
+    _frameTimer.record(record);
 }
 
 void XRState::updateVisibilityMaskTransform(osg::Camera *camera,
@@ -2241,7 +3008,8 @@ void XRState::updateVisibilityMaskTransform(osg::Camera *camera,
 }
 
 void XRState::initialDrawCallback(osg::RenderInfo &renderInfo,
-                                  View::Flags flags)
+                                  View::Flags flags,
+                                  uint32_t viewMask)
 {
     if (flags & View::CAM_TOXR_BIT)
     {
@@ -2254,6 +3022,22 @@ void XRState::initialDrawCallback(osg::RenderInfo &renderInfo,
         }
     }
 
+    if (_dynamicResolution.valid())
+    {
+        // Rescale the cameras to the frame's scale, before the first camera
+        // of the frame is drawn
+        OpenXR::Session::Frame *frame = _frames.getFrame(renderInfo.getState()->getFrameStamp());
+        if (frame)
+            for (auto &appView: _appViews)
+                appView->setResolutionScale(frame->getRenderScale());
+
+        // Viewports are rescaled in place, so make sure they're reapplied
+        osg::State &state = *renderInfo.getState();
+        state.haveAppliedAttribute(osg::StateAttribute::VIEWPORT);
+        for (unsigned int i = 0; i < _xrViews.size(); ++i)
+            state.haveAppliedAttribute(osg::StateAttribute::VIEWPORTINDEXED, i);
+    }
+
     if (flags & View::CAM_MVR_SCENE_BIT)
     {
         startRendering(renderInfo.getState()->getFrameStamp());
@@ -2261,14 +3045,36 @@ void XRState::initialDrawCallback(osg::RenderInfo &renderInfo,
         // Get up to date depth info from camera's projection matrix
         _depthInfo.setZRangeFromProjection(renderInfo.getCurrentCamera()->getProjectionMatrix());
     }
+
+    if (_gpuTimer.valid())
+    {
+        // Time the camera until its final draw callback
+        osg::State &state = *renderInfo.getState();
+        if (_gpuCameraSpan >= 0)
+            _gpuTimer->endSpan(state, _gpuCameraSpan);
+        _gpuCameraSpan = _gpuTimer->beginSpan(state, GpuTimer::TARGET_CAMERA,
+                                              viewMask, flags);
+    }
+}
+
+void XRState::finalDrawCallback(osg::RenderInfo &renderInfo)
+{
+    if (_gpuCameraSpan >= 0)
+    {
+        if (_gpuTimer.valid())
+            _gpuTimer->endSpan(*renderInfo.getState(), _gpuCameraSpan);
+        _gpuCameraSpan = -1;
+    }
 }
 
 void XRState::releaseGLObjects(osg::State *state)
 {
     // Release GL objects managed by the OpenXR session before the GL context is
     // destroyed
-    if (_currentState >= VRSTATE_SESSION)
+    if (_currentState >= VRSTATE_SESSION && _session.valid())
         _session->releaseGLObjects(state);
+    if (_gpuTimer.valid())
+        _gpuTimer->releaseGLObjects(state);
 }
 
 void XRState::swapBuffersImplementation(osg::GraphicsContext* gc)
@@ -2276,11 +3082,18 @@ void XRState::swapBuffersImplementation(osg::GraphicsContext* gc)
     // Submit rendered frame to compositor
     //m_device->submitFrame();
 
-    endFrame(gc->getState()->getFrameStamp());
+    // Unless it was already submitted before drawing mirrors
+    osg::FrameStamp *stamp = gc->getState()->getFrameStamp();
+    if (_endedFrameNumber != stamp->getFrameNumber())
+        endFrame(stamp);
 
     // Blit mirror texture to backbuffer
     //m_device->blitMirrorTexture(gc);
 
+    // Only present the desktop window every few frames if decimated
+    if (!shouldPresent(stamp))
+        return;
+
     // Run the default system swapBufferImplementation
     gc->swapBuffersImplementation();
 }
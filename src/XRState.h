@@ -14,18 +14,29 @@
 #include "OpenXR/SwapchainGroupSubImage.h"
 #include "OpenXR/Compositor.h"
 #include "OpenXR/DepthInfo.h"
+#include "OpenXR/ProbeCache.h"
 
 #include "XRFramebuffer.h"
+#include "DynamicResolution.h"
 #include "FrameStampedVector.h"
 #include "FrameStore.h"
+#include "FrameTimer.h"
+#include "GpuTimer.h"
+#include "XRAsyncOperation.h"
+#include "ObjectPool.h"
+#include "SharedCull.h"
 
+#include <osg/OperationThread>
 #include <osg/Referenced>
+#include <osg/Uniform>
 #include <osg/observer_ptr>
 #include <osg/ref_ptr>
 
+#include <osgXR/ActionEvent>
 #include <osgXR/ActionSet>
 #include <osgXR/CompositionLayer>
 #include <osgXR/Extension>
+#include <osgXR/FrameTimings>
 #include <osgXR/InteractionProfile>
 #include <osgXR/Settings>
 #include <osgXR/Space>
@@ -57,6 +68,7 @@ class XRState : public OpenXR::EventHandler
         typedef Settings::SwapchainMode SwapchainMode;
 
         XRState(Settings *settings, Manager *manager = nullptr);
+        ~XRState();
 
         /// Represents a swapchain group
         class XRSwapchain : public OpenXR::SwapchainGroup
@@ -96,6 +108,13 @@ class XRState : public OpenXR::EventHandler
 
                 void setupImage(const osg::FrameStamp *stamp);
 
+                /// Find whether all draw passes of a frame have been done.
+                bool isDrawn(const osg::FrameStamp *stamp) const
+                {
+                    return _imageFramebuffers.findStamp(stamp) >= 0 &&
+                           _drawPassesDone >= _numDrawPasses;
+                }
+
                 void preDrawCallback(osg::RenderInfo &renderInfo,
                                      unsigned int arrayIndex);
                 void postDrawCallback(osg::RenderInfo &renderInfo,
@@ -117,6 +136,8 @@ class XRState : public OpenXR::EventHandler
                 unsigned int _numDrawPasses;
                 unsigned int _drawPassesDone;
                 bool _imagesReady;
+                // Open GPU timing span (draw thread only)
+                int _gpuSpan;
         };
 
         /// Represents an OpenXR view
@@ -150,6 +171,12 @@ class XRState : public OpenXR::EventHandler
                     return _swapchainSubImage;
                 }
 
+                /// Get the dynamic resolution scale of the frame being updated.
+                float getResolutionScale() const
+                {
+                    return _state->_resolutionScale;
+                }
+
                 void endFrame(OpenXR::Session::Frame *frame);
 
             protected:
@@ -176,6 +203,7 @@ class XRState : public OpenXR::EventHandler
 
             protected:
                 XRView *_xrView;
+                float _resolutionScale;
 
                 osg::Matrix _viewMatrix;
                 osg::Matrix _projectionMatrix;
@@ -290,7 +318,8 @@ class XRState : public OpenXR::EventHandler
         /// Find if updates are needed for state changes.
         bool isStateUpdateNeeded() const
         {
-            return _currentState > _downState || _currentState < _upState;
+            return _currentState > _downState || _currentState < _upState ||
+                   _asyncOperation.valid();
         }
 
         /// Get the session object.
@@ -302,7 +331,7 @@ class XRState : public OpenXR::EventHandler
         /// Find if a VR session is running.
         bool isRunning() const
         {
-            if (_currentState < VRSTATE_SESSION)
+            if (_currentState < VRSTATE_SESSION || !_session.valid())
                 return false;
             return _session->isRunning() && !_session->isLost();
         }
@@ -446,12 +475,34 @@ class XRState : public OpenXR::EventHandler
             return _settings->getUnitsPerMeter();
         }
 
+        /// Get a snapshot of recent frame timings.
+        void getFrameTimings(FrameTimings &timings) const
+        {
+            _frameTimer.snapshot(timings);
+            if (_gpuTimer.valid())
+                _gpuTimer->snapshot(timings);
+        }
+
+        /// Get the angle to inflate culling frustums for late latching.
+        float getLateLatchingCullMargin() const
+        {
+            return _useLateLatching ? _settingsCopy.getLateLatchingCullMargin()
+                                    : 0.0f;
+        }
+
         /// Find whether actions have been updated.
         bool getActionsUpdated() const;
 
         /// Arrange reinit as needed of action setup.
         void syncActionSetup();
 
+        /// Take the action events queued since the last call.
+        void getActionEvents(std::vector<ActionEvent> &events)
+        {
+            events.clear();
+            events.swap(_actionEvents);
+        }
+
         /// Add a composition layer
         void addCompositionLayer(CompositionLayer::Private *layer);
 
@@ -464,6 +515,17 @@ class XRState : public OpenXR::EventHandler
         /// Perform a regular update.
         void update();
 
+        /**
+         * Stop the viewer's threads.
+         * This is for shutting down when frames may no longer be rendered,
+         * so that work which would be done on the graphics thread can still
+         * complete.
+         * @return Whether threads were running.
+         */
+        bool stopViewerThreading();
+        /// Restart the viewer's threads after stopViewerThreading().
+        void startViewerThreading();
+
         /// Recenter the local space.
         bool recenterLocalSpace();
 
@@ -482,18 +544,51 @@ class XRState : public OpenXR::EventHandler
         void onSessionStateEnd(OpenXR::Session *session, bool retry) override;
         void onSessionStateReady(OpenXR::Session *session) override;
         void onSessionStateStopping(OpenXR::Session *session, bool loss) override;
+        /// Stop frame pacing and end a stopping session, if frames allow.
+        bool finishStoppingSession();
         void onSessionStateFocus(OpenXR::Session *session) override;
         void onSessionStateUnfocus(OpenXR::Session *session) override;
 
-        osg::ref_ptr<OpenXR::Session::Frame> getFrame(osg::FrameStamp *stamp);
+        OpenXR::Session::Frame *getFrame(osg::FrameStamp *stamp);
+        /**
+         * Wait for the current frame from the update thread.
+         * This must happen before update slaves and cull look up the frame,
+         * and makes any per-frame changes that are restricted to the update
+         * thread, such as throttling idle frames and choosing a resolution
+         * scale.
+         */
+        void updateFrame();
+        /// Find whether a waited frame will be displayed, from any thread.
+        bool shouldRender(const osg::FrameStamp *stamp) const
+        {
+            OpenXR::Session::Frame *frame = _frames.getFrame(stamp);
+            return frame && frame->shouldRender();
+        }
+        void applyResolutionScale(OpenXR::Session::Frame *frame);
+        void setIdle(bool idle);
         void startRendering(osg::FrameStamp *stamp);
-        void endFrame(osg::FrameStamp *stamp);
+        void endFrame(const osg::FrameStamp *stamp);
+        /**
+         * End the OpenXR frame before a mirror is drawn.
+         * This only happens once every view has been drawn into, so that
+         * drawing mirrors to the desktop window doesn't delay submission.
+         * Called from the draw thread.
+         */
+        void endFrameBeforeMirror(const osg::FrameStamp *stamp);
+        /// Find whether the desktop window and mirrors present a frame.
+        bool shouldPresent(const osg::FrameStamp *stamp) const
+        {
+            return _mirrorDecimation <= 1 ||
+                   !(stamp->getFrameNumber() % _mirrorDecimation);
+        }
 
         static void updateVisibilityMaskTransform(osg::Camera *camera,
                                                   osg::MatrixTransform *transform);
 
         void initialDrawCallback(osg::RenderInfo &renderInfo,
-                                 View::Flags flags);
+                                 View::Flags flags,
+                                 uint32_t viewMask = 0);
+        void finalDrawCallback(osg::RenderInfo &renderInfo);
         void releaseGLObjects(osg::State *state);
         void swapBuffersImplementation(osg::GraphicsContext* gc);
 
@@ -564,6 +659,8 @@ class XRState : public OpenXR::EventHandler
 
         /**
          * Choose an RGBA swapchain format.
+         * @param formats                   Swapchain formats supported by the
+         *                                  session.
          * @param bestRGBBits               Desired number of combined RGB bits.
          * @param bestAlphaBits             Desired number of alpha bits.
          * @param preferredRGBEncodingMask  Mask of preferred RGB encodings (see
@@ -572,7 +669,8 @@ class XRState : public OpenXR::EventHandler
          *                                  Settings::Encoding).
          * @return The chosen OpenGL swapchain format.
          */
-        int64_t chooseRGBAFormat(unsigned int bestRGBBits,
+        int64_t chooseRGBAFormat(const OpenXR::Session::SwapchainFormats &formats,
+                                 unsigned int bestRGBBits,
                                  unsigned int bestAlphaBits,
                                  uint32_t preferredRGBEncodingMask,
                                  uint32_t allowedRGBEncodingMask) const;
@@ -593,6 +691,8 @@ class XRState : public OpenXR::EventHandler
                                          uint32_t allowedDepthEncodingMask) const;
         /**
          * Choose a depth / stencil swapchain format for submission to OpenXR.
+         * @param formats                    Swapchain formats supported by the
+         *                                   session.
          * @param bestDepthBits              Desired number of depth bits.
          * @param bestStencilBits            Desired number of stencil bits.
          * @param preferredDepthEncodingMask Mask of preferred depth encodings
@@ -601,7 +701,8 @@ class XRState : public OpenXR::EventHandler
          *                                   (see Settings::Encoding).
          * @return The chosen OpenGL depth / stencil swapchain format.
          */
-        int64_t chooseDepthFormat(unsigned int bestDepthBits,
+        int64_t chooseDepthFormat(const OpenXR::Session::SwapchainFormats &formats,
+                                  unsigned int bestDepthBits,
                                   unsigned int bestStencilBits,
                                   uint32_t preferredDepthEncodingMask,
                                   uint32_t allowedDepthEncodingMask) const;
@@ -618,12 +719,49 @@ class XRState : public OpenXR::EventHandler
             return _useVisibilityMask &&
                 (camera->getClearMask() & GL_DEPTH_BUFFER_BIT);
         }
+        bool needsVisibilityMaskCulling() const
+        {
+            // The shared cull must include what all views can see
+            return _useVisibilityMask && !_sharedCull.valid();
+        }
+        // Shared culling of slave cameras, or nullptr
+        SharedCull *getSharedCull()
+        {
+            return _sharedCull.get();
+        }
+
+        // Per-view culling of single pass views
+        bool needsMultiViewCulling() const
+        {
+            return _settingsCopy.getMultiViewCulling();
+        }
         void setupSceneViewVisibilityMasks(osg::Camera *camera,
                                            osg::ref_ptr<osg::MatrixTransform> &transform);
         osg::ref_ptr<osg::Geode> setupVisibilityMask(osg::Camera *camera,
                                                      uint32_t viewIndex,
                                                      osg::ref_ptr<osg::MatrixTransform> &transform);
 
+        /// How single pass visibility masks are routed to views.
+        typedef enum {
+            /// Geometry shader sets gl_ViewportIndex (and gl_Layer).
+            VIS_MASK_ROUTE_GEOMETRY_SHADER,
+            /// Vertex shader discards other values of gl_ViewID_OVR.
+            VIS_MASK_ROUTE_OVR_MULTIVIEW,
+            /// Vertex shader discards other views of gl_InstanceID.
+            VIS_MASK_ROUTE_INSTANCED,
+        } VisibilityMaskRouting;
+        /**
+         * Set up visibility masks for a single pass multiview camera.
+         * The per-view projection matrices (without view offsets) must be
+         * written by the AppView into the @p projections uniform array
+         * "osgxr_visibility_mask_projections".
+         */
+        void setupMultiViewVisibilityMasks(osg::Camera *camera,
+                                           const std::vector<uint32_t> &viewIndices,
+                                           VisibilityMaskRouting routing,
+                                           osg::Uniform *projections,
+                                           osg::ref_ptr<osg::MatrixTransform> &transform);
+
     protected:
 
         typedef enum {
@@ -644,6 +782,42 @@ class XRState : public OpenXR::EventHandler
             DOWN_SOON,
         } DownResult;
 
+        /// Settings copied for upSystemWorker() to read.
+        struct SystemInputs
+        {
+            Settings::FormFactor formFactor;
+            uint32_t preferredEnvBlendModeMask;
+            uint32_t allowedEnvBlendModeMask;
+            std::string probeCacheFile;
+        };
+
+        /// Results written by upSystemWorker(), published by upSystem().
+        struct SystemResults
+        {
+            XrFormFactor formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+            OpenXR::System *system = nullptr;
+            OpenXR::ProbeCache probeCache;
+            bool probeCacheDirty = false;
+            const OpenXR::System::ViewConfiguration *chosenViewConfig = nullptr;
+            XrEnvironmentBlendMode chosenEnvBlendMode = XR_ENVIRONMENT_BLEND_MODE_MAX_ENUM;
+        };
+
+        /**
+         * Session objects handed to and from the graphics thread.
+         * The graphics thread only touches these while a session transition
+         * is queued on it. The update thread publishes them into the XRState
+         * members after bringing a session up, and when taking it down the
+         * graphics thread takes those used by draw callbacks itself.
+         */
+        struct SessionGraphics
+        {
+            osg::ref_ptr<OpenXR::Session> session;
+            std::vector<osg::ref_ptr<XRView> > xrViews;
+            std::list<CompositionLayer::Private *> compositionLayers;
+            osg::ref_ptr<GpuTimer> gpuTimer;
+            bool useDepthInfo = false;
+        };
+
         // Pre-instance probing
         void probe() const;
         void unprobe() const;
@@ -653,22 +827,64 @@ class XRState : public OpenXR::EventHandler
         DownResult downInstance();
         UpResult upSystem();
         DownResult downSystem();
+        // Parts of instance & system transitions run on the worker thread
+        UpResult upInstanceWorker(OpenXR::Instance *instance,
+                                  const std::string &appName,
+                                  uint32_t appVersion);
+        UpResult upSystemWorker(OpenXR::Instance *instance,
+                                const SystemInputs &inputs,
+                                SystemResults &results);
         UpResult upSession();
         DownResult downSession();
+        // Parts of session transitions using the GL context
+        UpResult upSessionGraphics(SessionGraphics &graphics);
+        void downSessionGraphics(SessionGraphics &graphics);
+        // Take the session objects used by draw callbacks, on the graphics
+        // thread so no draw is still using them
+        void takeSessionGraphics(SessionGraphics &graphics);
+        // Publish the session set up by upSessionGraphics()
+        UpResult finishUpSession();
         UpResult upActions();
         DownResult downActions();
 
-        // Drop the _session and check it gets cleaned up
-        bool dropSessionCheck();
+        // Drop a session reference and check it gets cleaned up
+        bool dropSessionCheck(osg::ref_ptr<OpenXR::Session> &session);
+
+        /**
+         * Start GL context sensitive work for a state transition.
+         * If the viewer is threaded this is queued to run on the graphics
+         * thread which has the GL context current, otherwise it is run
+         * immediately with the GL context made current.
+         * @return true if the work has already completed.
+         */
+        bool startGraphicsOperation(const std::string &name, bool up,
+                                    const XRAsyncOperation::Function &function);
+        /**
+         * Start slow work for a state transition which doesn't need the GL
+         * context.
+         * This is queued to run on the worker thread so as not to stall the
+         * update thread, and completion must be waited for with
+         * finishAsyncOperation().
+         */
+        void startWorkerOperation(const std::string &name, bool up,
+                                  const XRAsyncOperation::Function &function);
+        /**
+         * Check whether queued state transition work has completed.
+         * @return true if completed, in which case it is forgotten.
+         */
+        bool finishAsyncOperation();
 
         // Set up a single swapchain containing multiple viewports
-        bool setupSingleSwapchain(int64_t format, int64_t depthFormat = 0,
+        bool setupSingleSwapchain(SessionGraphics &graphics,
+                                  int64_t format, int64_t depthFormat = 0,
                                   GLenum fallbackDepthFormat = 0);
         // Set up a single swapchain containing multiple layers
-        bool setupLayeredSwapchain(int64_t format, int64_t depthFormat = 0,
+        bool setupLayeredSwapchain(SessionGraphics &graphics,
+                                   int64_t format, int64_t depthFormat = 0,
                                    GLenum fallbackDepthFormat = 0);
         // Set up a swapchain for each view
-        bool setupMultipleSwapchains(int64_t format, int64_t depthFormat = 0,
+        bool setupMultipleSwapchains(SessionGraphics &graphics,
+                                     int64_t format, int64_t depthFormat = 0,
                                      GLenum fallbackDepthFormat = 0);
         // Set up slave cameras
         void setupSlaveCameras();
@@ -678,6 +894,8 @@ class XRState : public OpenXR::EventHandler
         void setupGeomShadersCameras();
         // Set up OVR_multiview VR mode cameras
         void setupOVRMultiviewCameras();
+        // Set up instanced VR mode cameras
+        void setupInstancedCameras();
 
         osg::ref_ptr<Settings> _settings;
         Settings _settingsCopy;
@@ -698,6 +916,7 @@ class XRState : public OpenXR::EventHandler
         std::set<ActionSet::Private *> _actionSets;
         std::set<InteractionProfile::Private *> _interactionProfiles;
         std::map<std::string, std::weak_ptr<Subaction::Private>> _subactions;
+        std::vector<ActionEvent> _actionEvents;
 
         // Spaces
         std::set<Space::Private *> _spaces;
@@ -720,8 +939,20 @@ class XRState : public OpenXR::EventHandler
         mutable std::string _stateString;
         /// Whether state has changed since the last update.
         bool _stateChanged;
-        /// Whether threading was in use prior to update().
+        /// Whether a stopping session waits for frames to be discarded.
+        bool _stoppingSession;
+        bool _stoppingSessionLoss;
+        /// Whether viewer threads were running at the start of update().
         bool _wasThreading;
+        // State transition waiting on the graphics or worker thread
+        osg::ref_ptr<XRAsyncOperation> _asyncOperation;
+        bool _asyncOperationUp;
+        bool _asyncOperationGraphics;
+        UpResult _asyncUpResult;
+        SessionGraphics _sessionGraphics;
+        SystemResults _systemResults;
+        /// Thread for state transition work not needing the GL context.
+        osg::ref_ptr<osg::OperationThread> _worker;
 
         // Session setup
         osg::observer_ptr<osgViewer::ViewerBase> _viewer;
@@ -738,6 +969,7 @@ class XRState : public OpenXR::EventHandler
         osg::ref_ptr<OpenXR::Instance> _instance;
         bool _useDepthInfo;
         bool _useVisibilityMask;
+        bool _useLateLatching;
         OpenXR::Instance::Result _lastError;
         OpenXR::Instance::Result _lastRunError;
 
@@ -746,6 +978,11 @@ class XRState : public OpenXR::EventHandler
         OpenXR::System *_system;
         const OpenXR::System::ViewConfiguration *_chosenViewConfig;
         XrEnvironmentBlendMode _chosenEnvBlendMode;
+        // Runtime capabilities cached on disk
+        OpenXR::ProbeCache _probeCache;
+        bool _probeCacheDirty;
+        // When instance creation last started, for reporting startup time
+        osg::Timer_t _startupTick;
 
         // Session related
         VRMode _vrMode;
@@ -753,8 +990,31 @@ class XRState : public OpenXR::EventHandler
         osg::ref_ptr<OpenXR::Session> _session;
         std::vector<osg::ref_ptr<XRView> > _xrViews;
         std::vector<osg::ref_ptr<AppView> > _appViews;
+        osg::ref_ptr<SharedCull> _sharedCull;
         FrameStore _frames;
+        osg::ref_ptr<FramePacer> _framePacer;
+        FrameTimer _frameTimer;
+        // Swapchain timings of the frame being drawn (draw thread only)
+        FrameTimings::Record _drawTimings;
+        osg::ref_ptr<GpuTimer> _gpuTimer;
+        // Open GPU timing span of the camera being drawn (draw thread only)
+        int _gpuCameraSpan;
+        osg::ref_ptr<DynamicResolution> _dynamicResolution;
+        // Resolution scale of the frame being updated (update thread only)
+        float _resolutionScale;
+        // When the current frame began rendering (draw thread only)
+        osg::Timer_t _renderStartTick;
+        // Whether the runtime doesn't want frames rendered (update thread only)
+        bool _idle;
+        bool _idleFrameRateLimited;
+        double _savedMaxFrameRate;
+        // Desktop window swap decimation while running
+        unsigned int _mirrorDecimation;
+        bool _savedSyncToVBlank;
+        // OSG frame number of the last ended frame (draw thread only)
+        unsigned int _endedFrameNumber;
         osg::ref_ptr<OpenXR::CompositionLayerProjection> _projectionLayer;
+        ObjectPool<OpenXR::CompositionLayerProjection> _projectionLayerPool;
         OpenXR::DepthInfo _depthInfo;
         osg::ref_ptr<osg::Program> _visibilityMaskProgram;
 };
@@ -10,6 +10,8 @@
 
 #include <osg/Camera>
 #include <osg/GraphicsContext>
+#include <osgUtil/CullVisitor>
+#include <osgViewer/GraphicsWindow>
 
 namespace osgXR {
 
@@ -17,15 +19,17 @@ class InitialDrawCallback : public osg::Camera::DrawCallback
 {
     public:
 
-        InitialDrawCallback(osg::ref_ptr<XRState> xrState, View::Flags flags) :
+        InitialDrawCallback(osg::ref_ptr<XRState> xrState, View::Flags flags,
+                            uint32_t viewMask = 0) :
             _xrState(xrState),
-            _flags(flags)
+            _flags(flags),
+            _viewMask(viewMask)
         {
         }
 
         void operator()(osg::RenderInfo& renderInfo) const override
         {
-            _xrState->initialDrawCallback(renderInfo, _flags);
+            _xrState->initialDrawCallback(renderInfo, _flags, _viewMask);
         }
 
         void releaseGLObjects(osg::State* state) const override
@@ -37,6 +41,55 @@ class InitialDrawCallback : public osg::Camera::DrawCallback
 
         osg::observer_ptr<XRState> _xrState;
         View::Flags _flags;
+        uint32_t _viewMask;
+};
+
+class FinalDrawCallback : public osg::Camera::DrawCallback
+{
+    public:
+
+        explicit FinalDrawCallback(osg::ref_ptr<XRState> xrState) :
+            _xrState(xrState)
+        {
+        }
+
+        void operator()(osg::RenderInfo& renderInfo) const override
+        {
+            _xrState->finalDrawCallback(renderInfo);
+        }
+
+    protected:
+
+        osg::observer_ptr<XRState> _xrState;
+};
+
+// Skips culling of a camera for frames which won't be displayed, so that the
+// frame's draw does no work and doesn't clear whatever framebuffer is bound
+class IdleCullCallback : public osg::NodeCallback
+{
+    public:
+
+        explicit IdleCullCallback(osg::ref_ptr<XRState> xrState) :
+            _xrState(xrState)
+        {
+        }
+
+        void operator()(osg::Node *node, osg::NodeVisitor *nv) override
+        {
+            osg::ref_ptr<XRState> xrState;
+            auto *cv = dynamic_cast<osgUtil::CullVisitor *>(nv);
+            if (cv && _xrState.lock(xrState) &&
+                !xrState->shouldRender(cv->getFrameStamp()))
+            {
+                cv->getCurrentRenderStage()->setClearMask(0);
+                return;
+            }
+            traverse(node, nv);
+        }
+
+    protected:
+
+        osg::observer_ptr<XRState> _xrState;
 };
 
 class PreDrawCallback : public osg::Camera::DrawCallback
@@ -109,6 +162,29 @@ class SwapCallback : public osg::GraphicsContext::SwapCallback
         int _frameIndex;
 };
 
+// Changes vsync of a window from its graphics thread, with the context current
+class SyncToVBlankOperation : public osg::GraphicsOperation
+{
+    public:
+
+        explicit SyncToVBlankOperation(bool on) :
+            osg::GraphicsOperation("osgXR SyncToVBlank", false),
+            _on(on)
+        {
+        }
+
+        void operator()(osg::GraphicsContext* gc) override
+        {
+            auto *window = dynamic_cast<osgViewer::GraphicsWindow*>(gc);
+            if (window)
+                window->setSyncToVBlank(_on);
+        }
+
+    private:
+
+        bool _on;
+};
+
 }
 
 #endif
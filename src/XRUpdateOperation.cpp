@@ -16,4 +16,5 @@ XRUpdateOperation::XRUpdateOperation(osg::ref_ptr<XRState> state) :
 void XRUpdateOperation::operator () (osg::Object *obj)
 {
     _state->update();
+    _state->updateFrame();
 }